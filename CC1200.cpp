@@ -30,6 +30,16 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "CC1200.h"
 
+#if defined(CC1200_INSTRUMENT)
+	#define INSTR_SCOPE(api)		_InstrScope _instrScope(api)
+	#define INSTR_COUNT(counter)	(_INSTR.counter++)
+	#define INSTR_STATUS(status)	_instr_status(status)
+#else
+	#define INSTR_SCOPE(api)
+	#define INSTR_COUNT(counter)
+	#define INSTR_STATUS(status)	((void)(status))
+#endif
+
 /* Basic Read-Write Access
 																	R/~W B A5 A4 A3 A2 A1 A0 */
 #define WRITE_SINGLE			0x00  // Single Byte Write Address -  0  0  x  x  x  x  x  x
@@ -41,12 +51,85 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define RADIO_FIFO_ACCESS_STD   0x3F
 #define RADIO_FIFO_ACCESS_DMA   0x3E
 
-// RSSI Offset (to be deducted)
-#define RSSI_OFFSET				0x30  //dec = 48
+// Received-frame queue read chain
+#define RXQ_COUNT				0	// Read NUM_RXBYTES
+#define RXQ_READ				1	// Read the rest of the frame from the RX FIFO
+#define RXQ_IDLE				2	// Discard: SIDLE
+#define RXQ_FLUSH				3	// Discard: SFRX
+#define RXQ_RX					4	// Back to RX
+#define RXQ_CONFIG				5	// Read PKT_CFG1 (APPEND_STATUS)
+#define RXQ_LENGTH				6	// Read the length byte of the next frame
+
+// MARC_STATUS1 cause (0x00 - 0x0B) to dispatcher slot. TX_OK/RX_OK are flags tested first.
+static const uint8_t IRQ_CAUSE_TABLE[] =
+{
+	IRQ_NONE,				// MARC_STATUS1_OUT_NONE
+	IRQ_RX_TIMEOUT,			// MARC_STATUS1_OUT_RX_TIMEOUT
+	IRQ_RX_TERM,			// MARC_STATUS1_OUT_RX_TERM
+	IRQ_SYNC_LOST,			// MARC_STATUS1_OUT_EWOR_SYNC_LOST
+	IRQ_LENGTH_DROP,		// MARC_STATUS1_OUT_PACKET_DROP_LEN
+	IRQ_ADDRESS_DROP,		// MARC_STATUS1_OUT_PACKET_DROP_ADR
+	IRQ_CRC_DROP,			// MARC_STATUS1_OUT_PACKET_DROP_CRC
+	IRQ_TX_FIFO_ERROR,		// MARC_STATUS1_OUT_TX_FIFO_OVERR
+	IRQ_TX_FIFO_ERROR,		// MARC_STATUS1_OUT_TX_FIFO_UNERR
+	IRQ_RX_FIFO_ERROR,		// MARC_STATUS1_OUT_RX_FIFO_OVERR
+	IRQ_RX_FIFO_ERROR,		// MARC_STATUS1_OUT_RX_FIFO_UNERR
+	IRQ_CCA_FAILED			// MARC_STATUS1_OUT_TXONCCA_FAILED
+};
+
+// Preamble bits per PREAMBLE_CFG1.NUM_PREAMBLE [5:2]
+static const uint8_t PREAMBLE_BITS[16] = { 0, 4, 8, 12, 16, 24, 32, 40, 48, 56, 64, 96, 192, 240, 0, 0 };
+
+// Sync word bits per SYNC_CFG1.SYNC_MODE [7:5]
+static const uint8_t SYNC_BITS[8] = { 0, 11, 16, 18, 24, 32, 16, 16 };
+
+// WOR_CFG1.EVENT1 [2:0]: RC oscillator periods from wake-up to RX start (XOSC settling)
+static const uint8_t SNIFF_EVENT1_PERIODS[8] = { 4, 6, 8, 12, 16, 24, 32, 48 };
+
+// Asynchronous radio operation and its steps
+#define RADIO_OP_NONE			0
+#define RADIO_OP_TX				1
+#define RADIO_OP_RX				2
+#define RADIO_IDLE				0	// SIDLE
+#define RADIO_FLUSH				1	// SFTX / SFRX
+#define RADIO_WRITE				2	// TX: frame to the TX FIFO
+#define RADIO_STROBE			3	// STX / SRX, then wait for the packet interrupt
+#define RADIO_STATUS			4	// Read MARC_STATUS1 (clears it)
+#define RADIO_COUNT				5	// RX: read NUM_RXBYTES
+#define RADIO_READ				6	// RX: frame from the RX FIFO
+#define RADIO_RECOVER			7	// Flush after a FIFO error, then complete (TX) or listen again (RX)
+#define RADIO_DISCARD			8	// SIDLE after a frame longer than the buffer (RX) or a busy channel (TX)
+#define RADIO_DISCARDED			9	// SFRX / SFTX, then complete
 
 // Define CC1200 chip as cc1200
 CC1200 cc1200;
 
+// SPI transaction engine
+spiTransaction_t *volatile CC1200::_QUEUE_HEAD = NULL;
+spiTransaction_t *volatile CC1200::_QUEUE_TAIL = NULL;
+spiTransaction_t *volatile CC1200::_ACTIVE = NULL;
+volatile bool CC1200::_BUS_BUSY = false;
+bool CC1200::_DRAINING = false;
+
+// Radios on the bus
+CC1200 *CC1200::_RADIOS[CC1200_MAX_RADIOS];
+uint8_t CC1200::_RADIO_COUNT = 0;
+uint8_t CC1200::_SERVICE_NEXT = 0;
+bool CC1200::_SPI_STARTED = false;
+
+#if defined(CC1200_INSTRUMENT)
+instrumentation_t CC1200::_INSTR;
+uint8_t CC1200::_INSTR_STATE = 0xFF;
+#endif
+
+#if defined(__AVR__)
+// SPI Serial Transfer Complete
+ISR(SPI_STC_vect)
+{
+	CC1200::ServiceSpi();
+}
+#endif
+
 // Standard initialization - using default pins [SS, MOSI, MISO, SCK, 9 (RadioReset)]
 void CC1200::Init(void)
 {
@@ -65,22 +148,42 @@ void CC1200::Init(uint8_t SS_PIN, uint8_t MOSI_PIN, uint8_t MISO_PIN, uint8_t SC
 	// SPI Setup
 	_spi_begin();
 
+	// Register on the bus (once per instance)
+	uint8_t i = 0;
+	while (i < _RADIO_COUNT && _RADIOS[i] != this)
+	{
+		i++;
+	}
+	if (i == _RADIO_COUNT && _RADIO_COUNT < CC1200_MAX_RADIOS)
+	{
+		_RADIOS[_RADIO_COUNT++] = this;
+	}
+
 	// Radio Setup
+	_bootStart = micros();
+	memset(&_bootStats, 0, sizeof(_bootStats));
 	_RESET_PIN = RESET_PIN;
 	if (_RESET_PIN > PIN_UNUSED)
 	{
-		pinMode(_RESET_PIN, OUTPUT); delay(100);
+		digitalWrite(_RESET_PIN, HIGH);
+		pinMode(_RESET_PIN, OUTPUT);
+	}
+	if (Reset(true))
+	{
+		_bootStats.READY_US = micros() - _bootStart;
 	}
-	Reset(true);
-
-	delay(1000);
 }
 
-// Configure Radio
-void CC1200::Configure(const registerSetting_t settings[], uint8_t len)
+// Configure Radio. Returns TRUE if the chip answers and reads back the last configuration register written by the
+// table: it is out of reset and took the final write. Status registers (read-only) in the table are skipped, the
+// values of the burst runs before it are not read back. FALSE for a table without a configuration register.
+bool CC1200::Configure(const registerSetting_t settings[], uint8_t len)
 {
+	INSTR_SCOPE(INSTR_CONFIGURE);
+
 	// Method 1: Timing = (toggle of CSN/SS pin + 2 if-loops) * N	: SLOWER
 	// Method 2: Timing =  toggle of CSN/SS pin + N if-loops		: FASTER
+	// Method 3: Timing =  toggle of CSN/SS pin per run of consecutive registers + 1 byte per register : FASTEST
 
 	// METHOD 1: Using _spi_write_register() method
 	/*for (uint8_t i = 0; i < len; i++)
@@ -88,43 +191,116 @@ void CC1200::Configure(const registerSetting_t settings[], uint8_t len)
 		_spi_write_register(settings[i].REGISTER, &(settings[i].VALUE), 1);
 	}*/
 
-	// METHOD 2: Alternative of _spi_write_register() method
-	digitalWrite(_SS_PIN, LOW); // Pull the SS pin LOW - Active
-	wait_pin_low(_MISO_PIN); // Wait until MISO pin goes LOW
-	
+	// METHOD 3: Stage the table in a register image (sorted by address, last value wins), then write runs of
+	// consecutive registers as burst writes. Single registers and registers outside the image share one CS.
+	if (len == 0)
+	{
+		return false;
+	}
+
+	byte image[CACHE_SIZE];
+	byte staged[(CACHE_SIZE + 7) / 8];
+	memset(staged, 0, sizeof(staged));
+
+	_spi_select();
 	for (uint8_t i = 0; i < len; i++)
 	{
-		bool normSpace = ((settings[i].REGISTER >> 8) == 0x2F) ? false : true;
-		if (normSpace)
+		int8_t index = _register_index(settings[i].REGISTER);
+		if (index >= 0)
 		{
-			_spi_transfer(WRITE_SINGLE | lowByte(settings[i].REGISTER));
-			_spi_transfer(settings[i].VALUE);
+			image[index] = settings[i].VALUE;
+			staged[index >> 3] |= (1 << (index & 0x07));
 		}
-		else
+		else if ((settings[i].REGISTER >> 8) == 0x2F)
 		{
 			_spi_transfer(WRITE_SINGLE | highByte(settings[i].REGISTER));
 			_spi_transfer(lowByte(settings[i].REGISTER));
 			_spi_transfer(settings[i].VALUE);
 		}
+		else
+		{
+			_spi_transfer(WRITE_SINGLE | lowByte(settings[i].REGISTER));
+			_spi_transfer(settings[i].VALUE);
+		}
+	}
+
+	// Runs [start, index) of staged registers within one space. Pass 0: singles in this CS. Pass 1: bursts.
+	for (uint8_t pass = 0; pass < 2; pass++)
+	{
+		for (uint8_t index = 0; index < CACHE_SIZE; )
+		{
+			if (!(staged[index >> 3] & (1 << (index & 0x07))))
+			{
+				index++;
+				continue;
+			}
+
+			uint8_t start = index++;
+			while (index < CACHE_SIZE && index != 0x2F && (staged[index >> 3] & (1 << (index & 0x07))))
+			{
+				index++;
+			}
+
+			uint8_t count = index - start;
+			if (pass == 0 && count == 1 && start < 0x2F)
+			{
+				_spi_transfer(WRITE_SINGLE | start);
+				_spi_transfer(image[start]);
+			}
+			else if (pass == 0 && count == 1)
+			{
+				_spi_transfer(WRITE_SINGLE | 0x2F);
+				_spi_transfer(start - 0x2F);
+				_spi_transfer(image[start]);
+			}
+			else if (pass == 1 && count > 1)
+			{
+				_spi_write_register((start < 0x2F) ? start : (0x2F00 | (start - 0x2F)), &image[start], count);
+			}
+		}
+
+		if (pass == 0)
+		{
+			_spi_deselect();
+		}
 	}
 
-	digitalWrite(_SS_PIN, HIGH); // Pull the SS pin HIGH - Inactive
+	if (_cacheEnabled && _cacheLoaded)
+	{
+		for (uint8_t i = 0; i < len; i++)
+		{
+			_cache_store(settings[i].REGISTER, settings[i].VALUE, false);
+		}
+	}
 
-	delay(2000);
+	// Ready check instead of a fixed delay: the chip answers (CHIP_RDYn LOW on select) and holds the last value
+	// written to a configuration register. Status registers (e.g. PARTVERSION) in the table are not written.
+	for (uint8_t i = len; i-- > 0; )
+	{
+		uint16_t address = settings[i].REGISTER;
+		if (address < 0x2F || ((address >> 8) == 0x2F && address < CC120X_WOR_TIME1))
+		{
+			byte value;
+			_spi_read_register(address, &value, 1);
+			return (value == settings[i].VALUE);
+		}
+	}
+	return false;
 }
 
 // Get Status/State info. Returned result is keepBits bitwise AND-ed with Right(+)/Left(-) shifted.
 byte CC1200::GetStat(StatType sType, byte keepBits, int8_t shiftLR)
 {
+	INSTR_SCOPE(INSTR_GET_STAT);
 	byte stat = 0x00;
 	uint16_t address = sType;
 
 	if (sType == STATUS)
 	{
-		digitalWrite(_SS_PIN, LOW); // Pull the SS pin LOW - Active
-		wait_pin_low(_MISO_PIN); // Wait until MISO pin goes LOW
+		_spi_select();
 		stat = _spi_transfer(CC120X_SNOP);
-		digitalWrite(_SS_PIN, HIGH); // Pull the SS pin HIGH - Inactive
+		_spi_deselect();
+		INSTR_STATUS(stat);
 	}
 	else
 	{
@@ -156,20 +332,27 @@ void CC1200::Strobe(uint8_t command)
 	}
 }
 
-// Reset the Chip. Performs Hard Reset if HWreset is TRUE else Soft Reset.
-void CC1200::Reset(bool HWreset)
+// Reset the Chip. Performs Hard Reset if HWreset is TRUE (and a reset pin is given) else Soft Reset.
+// Returns as soon as the chip is ready (CHIP_RDYn LOW), FALSE if it is not within BOOT_TIMEOUT_US.
+bool CC1200::Reset(bool HWreset)
 {
+	_cacheLoaded = false; // Registers back to defaults: reload the mirror on next use
+
 	if (HWreset && _RESET_PIN > PIN_UNUSED)
 	{
 		digitalWrite(_RESET_PIN, LOW); // Reset = Low
-		delay(1000);
+		delayMicroseconds(BOOT_RESET_PULSE_US);
 		digitalWrite(_RESET_PIN, HIGH);
-		delay(1000);
 	}
 	else
 	{
+		if (!WaitReady()) // Power-on: the strobe needs a ready chip
+		{
+			return false;
+		}
 		_spi_strobe(CC120X_SRES);
 	}
+	return WaitReady();
 }
 
 // Idle the Chip
@@ -212,17 +395,19 @@ void CC1200::FlushRxFifo(void)
 int CC1200::ResolveFifoErr(void)
 {
 	int rtn = 0;
-	byte state = cc1200.GetStat(StatType::MARC_STATE, 0x1F); // MARC_STATE [4:0]
+	byte state = GetStat(StatType::MARC_STATE, 0x1F); // MARC_STATE [4:0]
 
 	if (state == MARC_STATE_TX_FIFO_ERR)
 	{
 		FlushTxFifo();
+		INSTR_COUNT(FIFO_RECOVERIES);
 		rtn++;
 	}
 
 	if (state == MARC_STATE_RX_FIFO_ERR)
 	{
 		FlushRxFifo();
+		INSTR_COUNT(FIFO_RECOVERIES);
 		rtn++;
 	}
 
@@ -235,7 +420,7 @@ uint8_t CC1200::GetAddress(bool fast)
 	uint8_t devAddr = _DEVICE_ADDRESS;
 	if (!fast)
 	{
-		_spi_read_register(CC120X_DEV_ADDR, &devAddr, 1);
+		ReadRegister(CC120X_DEV_ADDR, &devAddr, 1);
 		_DEVICE_ADDRESS = devAddr; // Update (just in case)
 	}
 	return devAddr;
@@ -253,7 +438,14 @@ bool CC1200::ReadRegister(uint16_t address, byte readBuffer[], uint8_t len)
 {
 	if (len > 0)
 	{
-		_spi_read_register(address, readBuffer, len);
+		if (_cache_covers(address, len))
+		{
+			memcpy(readBuffer, &_CACHE[_cache_index(address)], len);
+		}
+		else
+		{
+			_spi_read_register(address, readBuffer, len);
+		}
 	}
 	return (len > 0);
 }
@@ -263,7 +455,17 @@ bool CC1200::WriteRegister(uint16_t address, byte writeBuffer[], uint8_t len)
 {
 	if (len > 0)
 	{
-		_spi_write_register(address, writeBuffer, len);
+		if (_cache_covers(address, len))
+		{
+			for (uint8_t i = 0; i < len; i++)
+			{
+				_cache_store(address + i, writeBuffer[i], true); // Written by Flush()
+			}
+		}
+		else
+		{
+			_spi_write_register(address, writeBuffer, len);
+		}
 	}
 	return (len > 0);
 }
@@ -271,7 +473,15 @@ bool CC1200::WriteRegister(uint16_t address, byte writeBuffer[], uint8_t len)
 // Update Register according to updateBits. (Different from WriteRegister)
 void CC1200::UpdateRegister(uint16_t address, byte updateBits)
 {
+	INSTR_SCOPE(INSTR_UPDATE_REGISTER);
 	byte oldValue, newValue;
+	if (_cache_covers(address, 1))
+	{
+		oldValue = _CACHE[_cache_index(address)];
+		_cache_store(address, oldValue | updateBits, true); // Written by Flush()
+		return;
+	}
+
 	_spi_read_register(address, &oldValue, 1);
 	newValue = oldValue | updateBits;
 	if (newValue != oldValue)
@@ -283,6 +493,7 @@ void CC1200::UpdateRegister(uint16_t address, byte updateBits)
 // Read from RX FIFO and return amount of bytes read.
 uint8_t CC1200::ReadRxFifo(byte readBuffer[])
 {
+	INSTR_SCOPE(INSTR_READ_RX_FIFO);
 	uint8_t readByte = 0;
 	_spi_read_register(CC120X_NUM_RXBYTES, &readByte, 1);
 	if (readByte > 0)
@@ -295,182 +506,2517 @@ uint8_t CC1200::ReadRxFifo(byte readBuffer[])
 // Write to TX FIFO. Assumption: [Length Address --Payload-- +1Byte] where Length = AddressLen(1) + PayloadLength. 
 void CC1200::WriteTxFifo(byte writeBuffer[], uint8_t len)
 {
+	INSTR_SCOPE(INSTR_WRITE_TX_FIFO);
 	if (len > 2) // 0: Length, 1: Target Address, 2: Source Address !!!
 	{
 		_spi_write_register(RADIO_FIFO_ACCESS_STD, writeBuffer, len + 1); // +1 otherwise original data overwritten !!!
 	}
 }
 
-/* SPI Core Methods */
-// Configure SPI
-void CC1200::_spi_begin(void)
+// Write [Length Target Source --Segments--] to the TX FIFO in one burst, straight from the segment buffers
+// (no staging copy). Length is filled in. Returns the bytes written, 0 if the frame exceeds the FIFO.
+uint8_t CC1200::WriteTxFifo(uint8_t target, uint8_t source, const txSegment_t segments[], uint8_t count)
 {
-	// Configure SPI Pins
-	pinMode(_SS_PIN, OUTPUT);
-	pinMode(_MOSI_PIN, OUTPUT);
-	pinMode(_MISO_PIN, INPUT);
-	pinMode(_SCK_PIN, OUTPUT);
-
-	digitalWrite(_SS_PIN, HIGH);
-	digitalWrite(_SCK_PIN, HIGH);
-	digitalWrite(_MOSI_PIN, LOW);
+	INSTR_SCOPE(INSTR_WRITE_TX_FIFO);
+	uint16_t length = 2; // Target, Source
+	for (uint8_t i = 0; i < count; i++)
+	{
+		length += segments[i].LEN;
+	}
+	if (length + 1 > FIFO_SIZE_BYTES)
+	{
+		return 0;
+	}
 
-	// SPI Configuration
-	/*
-	Spi prescaler:
-		SPI2X SPR1 SPR0
-			0     0     0    fosc/4
-			0     0     1    fosc/16
-			0     1     0    fosc/64
-			0     1     1    fosc/128
-			1     0     0    fosc/2
-			1     0     1    fosc/8
-			1     1     0    fosc/32
-			1     1     1    fosc/64
-	*/
-	//SPCR = ((1 << SPE) |					// SPI Enable
-	//		(0 << SPIE) |					// SPI Interupt Enable
-	//		(0 << DORD) |					// Data Order (0:MSB first / 1:LSB first)
-	//		(1 << MSTR) |					// Master/Slave select
-	//		(0 << SPR1) | (0 << SPR0) |		// SPI Clock Rate
-	//		(0 << CPOL) |					// Clock Polarity (0:SCK low / 1:SCK hi when idle)
-	//		(0 << CPHA));					// Clock Phase (0:leading / 1:trailing edge sampling)
-	//SPSR = (1 << SPI2X);					// Double Clock Rate
-	
-	byte dummy;
-	SPCR = 0;								// Reset to defaults
-	SPCR = _BV(SPE) | _BV(MSTR);			// SPI Enable as Master with speed = clk/4
-	dummy = SPCR;
-	dummy = SPDR;
+	_spi_select();
+	_spi_transfer(WRITE_BURST | RADIO_FIFO_ACCESS_STD);
+	_spi_transfer(length);
+	_spi_transfer(target);
+	_spi_transfer(source);
+	for (uint8_t i = 0; i < count; i++)
+	{
+		const byte *data = segments[i].DATA;
+		for (uint8_t j = 0; j < segments[i].LEN; j++)
+		{
+			_spi_transfer(data[j]);
+		}
+	}
+	_spi_deselect();
+	return length + 1;
 }
 
-// De-configure SPI
-void CC1200::_spi_end(void)
+// Poll CHIP_RDYn until the chip is ready (crystal stable, after reset or wake-up). FALSE on timeout.
+bool CC1200::WaitReady(uint32_t timeoutUs)
 {
-	// SPI Pin Directions
-	pinMode(_SS_PIN, INPUT);
-	pinMode(_MOSI_PIN, INPUT);
-	pinMode(_MISO_PIN, INPUT);
-	pinMode(_SCK_PIN, INPUT);
+	uint32_t start = micros();
+	while (!_spi_probe())
+	{
+		if (micros() - start >= timeoutUs)
+		{
+			return false;
+		}
+	}
+	return true;
+}
 
-	SPCR = 0;
-	//SPSR = (0 << SPI2X);					// Double Clock Rate
+// Poll MARC_STATE until it is marcState (e.g. IDLE after SCAL, RX after SRX). FALSE on timeout.
+bool CC1200::WaitState(uint8_t marcState, uint32_t timeoutUs)
+{
+	uint32_t start = micros();
+	while (GetStat(StatType::MARC_STATE, 0x1F) != marcState)
+	{
+		if (micros() - start >= timeoutUs)
+		{
+			return false;
+		}
+	}
+	return true;
 }
 
-// Strobe command via SPI
-void CC1200::_spi_strobe(uint8_t command)
+// Cold start without fixed delays: reset, configure and (rx = TRUE) enter RX, each step as soon as the chip is
+// ready. Every phase is bounded by BOOT_TIMEOUT_US. See GetBootStats() for the measured times.
+bool CC1200::FastStart(const registerSetting_t settings[], uint8_t len, bool rx)
 {
-	digitalWrite(_SS_PIN, LOW); // Pull the SS pin LOW - Active
-	//while (!digitalRead(_MOSI_PIN)); // Wait until MOSI pin goes HIGH
-	wait_pin_low(_MISO_PIN); // Wait until MISO pin goes LOw
-	_spi_transfer(command);
-	//Serial.println("  STROBE OK");
-	digitalWrite(_SS_PIN, HIGH); // Pull the SS pin HIGH - Inactive
+	BeginFastStart(settings, len, rx);
+	while (_bootPhase < BOOT_DONE)
+	{
+		ServiceFastStart(BOOT_TIMEOUT_US);
+	}
+	return (_bootPhase == BOOT_DONE);
 }
 
-// SPI Single Byte Read/Write
-uint8_t CC1200::_spi_transfer(uint8_t data)
+// Budgeted fast start: BeginFastStart() then call ServiceFastStart() until BOOT_DONE, BOOT_TIMEOUT or BOOT_FAILED.
+void CC1200::BeginFastStart(const registerSetting_t settings[], uint8_t len, bool rx)
 {
-	SPDR = data; //Serial.println("  DATA WAIT");
-	//while (!(SPSR & (1 << SPIF)));       // Wait until the byte has been sent
-	wait_spi(); //Serial.println("  DATA OK");
-	return SPDR;
+	_bootSettings = settings;
+	_bootLen = len;
+	_bootRx = rx;
+	_bootStart = micros();
+	memset(&_bootStats, 0, sizeof(_bootStats));
+	_boot_phase(BOOT_RESET);
 }
 
-// SPI Read - Single or Multiple Bytes from Normal/Extended Register space
-void CC1200::_spi_read_register(uint16_t address, uint8_t *buffer, uint8_t len)
+// Advance the fast start for at most about budgetUs (Configure() runs as one step). Returns the phase.
+uint8_t CC1200::ServiceFastStart(uint16_t budgetUs)
 {
-	/*
-		NORMAL[0x00-0x2E] or EXTENDED[0x2F00-0x2FFF] space
-	*/
-	bool normSpace = ((address >> 8) == 0x002F) ? false : true;
+	uint32_t start = micros();
+	while (_bootPhase < BOOT_DONE)
+	{
+		switch (_bootPhase)
+		{
+		case BOOT_RESET:
+			if (_RESET_PIN > PIN_UNUSED)
+			{
+				digitalWrite(_RESET_PIN, LOW);
+				delayMicroseconds(BOOT_RESET_PULSE_US);
+				digitalWrite(_RESET_PIN, HIGH);
+				_cacheLoaded = false;
+				_boot_phase(BOOT_WAIT_READY);
+			}
+			else if (_spi_probe())
+			{
+				_spi_strobe(CC120X_SRES);
+				_cacheLoaded = false;
+				_boot_phase(BOOT_WAIT_READY);
+			}
+			break;
+
+		case BOOT_WAIT_READY:
+			if (_spi_probe())
+			{
+				_bootStats.READY_US = micros() - _bootStart;
+				_boot_phase(BOOT_CONFIGURE);
+			}
+			break;
 
-	digitalWrite(_SS_PIN, LOW); // Pull the SS pin LOW - Active
-	wait_pin_low(_MISO_PIN); // Wait until MISO pin goes LOW
+		case BOOT_CONFIGURE:
+			if (_bootLen > 0 && !Configure(_bootSettings, _bootLen))
+			{
+				_boot_phase(BOOT_FAILED);
+				break;
+			}
+			_boot_phase(BOOT_WAIT_IDLE);
+			break;
 
-	if (normSpace) // Normal Address Space
-	{
-		if (len == 1) // Single Read
+		case BOOT_WAIT_IDLE:
+			if (GetStat(StatType::MARC_STATE, 0x1F) == MARC_STATE_IDLE)
+			{
+				_bootStats.IDLE_US = micros() - _bootStart;
+				if (_bootRx)
+				{
+					_spi_strobe(CC120X_SRX);
+				}
+				_boot_phase(_bootRx ? BOOT_WAIT_RX : BOOT_DONE);
+			}
+			break;
+
+		case BOOT_WAIT_RX:
+			if (GetStat(StatType::MARC_STATE, 0x1F) == MARC_STATE_RX)
+			{
+				_bootStats.RX_US = micros() - _bootStart;
+				_boot_phase(BOOT_DONE);
+			}
+			break;
+		}
+
+		if (_bootPhase < BOOT_DONE && micros() - _bootPhaseStart >= BOOT_TIMEOUT_US)
 		{
-			_spi_transfer(READ_SINGLE | lowByte(address));
-			buffer[0] = _spi_transfer(0xFF); // Put dummy byte to get the received byte
+			_bootPhase = BOOT_TIMEOUT;
 		}
-		else // Burst Read
+		if (micros() - start >= budgetUs)
 		{
-			_spi_transfer(READ_BURST | lowByte(address));
-			for (uint8_t i = 0; i < len; i++)
-			{
-				buffer[i] = _spi_transfer(0xFF); // Put dummy byte to get the received byte
-			}
+			break;
 		}
 	}
-	else // Extended Address Space
+	return _bootPhase;
+}
+
+// Boot timing of the last Init() / fast start
+bootStats_t CC1200::GetBootStats(void)
+{
+	return _bootStats;
+}
+
+// Send [Length Address --Payload--] (frame[0] + 1 bytes) and return at once. The radio is taken to IDLE, the
+// TX FIFO flushed and filled and TX strobed by queued SPI transactions. Completion comes from RadioIrq() on the
+// end-of-packet edge (e.g. GPIO2 PKT_SYNC_RXTX FALLING): callback(RADIO_OK) in interrupt context. With CCA
+// (ConfigureCca) a busy channel (TXONCCA_FAILED, e.g. through DispatchIrq()) completes with RADIO_CHANNEL_BUSY at
+// once, the TX FIFO flushed. FALSE if an operation is in progress or frame[0] + 1 bytes do not fit the TX FIFO.
+// Timeouts need ServiceRadio() in the main loop.
+bool CC1200::SendAsync(byte frame[], radioCallback_t callback, void *context, uint32_t timeoutUs)
+{
+	if (_radioOp != RADIO_OP_NONE || frame[0] >= FIFO_SIZE_BYTES) // frame[0] + 1 bytes must fit the TX FIFO
+	{
+		return false;
+	}
+
+	_radioOp = RADIO_OP_TX;
+	_radioWaiting = false;
+	_radioBuffer = frame;
+	_radioLen = frame[0] + 1;
+	_radioCallback = callback;
+	_radioContext = context;
+	_radioStart = micros();
+	_radioTimeout = timeoutUs;
+	_radio_submit(RADIO_IDLE, SPI_TRANS_STROBE, CC120X_SIDLE, NULL, 0);
+	return true;
+}
+
+// Receive one frame into buffer and return at once. Packets dropped by the chip (length, address, CRC) and
+// RX FIFO overflows are handled internally: the radio keeps listening. callback(RADIO_OK, len) runs in
+// interrupt context once the frame is in buffer. timeoutUs = 0: no timeout.
+bool CC1200::StartReceive(byte buffer[], uint8_t maxLen, radioCallback_t callback, void *context, uint32_t timeoutUs)
+{
+	if (_radioOp != RADIO_OP_NONE)
+	{
+		return false;
+	}
+
+	_radioOp = RADIO_OP_RX;
+	_radioWaiting = false;
+	_radioBuffer = buffer;
+	_radioLen = maxLen;
+	_radioCallback = callback;
+	_radioContext = context;
+	_radioStart = micros();
+	_radioTimeout = timeoutUs;
+	_radio_submit(RADIO_IDLE, SPI_TRANS_STROBE, CC120X_SIDLE, NULL, 0);
+	return true;
+}
+
+// Packet interrupt (end of packet). Decodes MARC_STATUS1 with one queued read. Call from the GPIO handler.
+// When DispatchIrq() serves the pin instead, it passes its MARC_STATUS1 read on and RadioIrq() is not needed.
+void CC1200::RadioIrq(void)
+{
+	if (_radioOp == RADIO_OP_NONE || !_radioWaiting)
+	{
+		return;
+	}
+	_radioWaiting = false;
+	_radio_submit(RADIO_STATUS, SPI_TRANS_READ, CC120X_MARC_STATUS1, &_radioReg, 1);
+}
+
+// Enforce the timeout of the operation in progress. Call from the main loop; the callback runs from here.
+void CC1200::ServiceRadio(void)
+{
+	if (_radioOp == RADIO_OP_NONE || _radioTimeout == 0 || micros() - _radioStart < _radioTimeout)
+	{
+		return;
+	}
+
+	uint8_t state = CC120X_SPI::EnterCritical();
+	bool idle = _radioWaiting; // Not in the middle of a step
+	_radioWaiting = false;
+	CC120X_SPI::ExitCritical(state);
+	if (!idle)
+	{
+		return;
+	}
+
+	_spi_strobe(CC120X_SIDLE);
+	_spi_strobe(_radioOp == RADIO_OP_TX ? CC120X_SFTX : CC120X_SFRX);
+	_radio_complete(RADIO_TIMEOUT, 0);
+}
+
+// Operation in progress
+bool CC1200::RadioBusy(void)
+{
+	return (_radioOp != RADIO_OP_NONE);
+}
+
+// Route GPIOx (0..3) to an output signal: IOCFGx = signal (GPIO_* from CC120X_Misc.h, | GPIO_INV to invert).
+// E.g. GPIO_MCU_WAKEUP for DispatchIrq(), GPIO_PKT_SYNC_RXTX for RadioIrq()/QueueRxFrame(), GPIO_RXFIFO_THR.
+bool CC1200::ConfigureGpio(uint8_t gpio, uint8_t signal)
+{
+	if (gpio > 3)
+	{
+		return false;
+	}
+	_spi_write_register(CC120X_IOCFG0 - gpio, &signal, 1);
+	return true;
+}
+
+// Register the handler of an interrupt cause (IRQ_*). NULL removes it. Handlers run in interrupt context.
+void CC1200::OnIrq(uint8_t cause, irqHandler_t handler, void *context)
+{
+	if (cause >= IRQ_CAUSES)
+	{
+		return;
+	}
+	uint8_t state = CC120X_SPI::EnterCritical();
+	_irqHandler[cause] = handler;
+	_irqContext[cause] = context;
+	CC120X_SPI::ExitCritical(state);
+}
+
+// Interrupt dispatcher. Call from the GPIO handler (e.g. GPIO0 = GPIO_MCU_WAKEUP, RISING). MARC_STATUS1 is read
+// once by a queued transaction and its cause decoded by table lookup; the pending SendAsync()/StartReceive()
+// gets the status first, then the registered handler runs. An interrupt during the read is served after it.
+void CC1200::DispatchIrq(void)
+{
+	if (_irqBusy)
+	{
+		_irqPending = true;
+		return;
+	}
+	_irqBusy = true;
+	_irqTrans.TYPE = SPI_TRANS_READ;
+	_irqTrans.ADDRESS = CC120X_MARC_STATUS1;
+	_irqTrans.BUFFER = &_irqStatus;
+	_irqTrans.LEN = 1;
+	_irqTrans.CALLBACK = _irq_dispatch;
+	_irqTrans.CONTEXT = this;
+	Submit(&_irqTrans);
+}
+
+// Serve this radio's interrupts from pin: GPIOx (0..3) is routed to GPIO_MCU_WAKEUP, not inverted (HIGH from the
+// event until MARC_STATUS1 is read), and the pin's RISING edge calls DispatchIrq() of this instance. Each radio
+// on the bus uses its own pin. Call after Init().
+bool CC1200::AttachIrq(uint8_t pin, uint8_t gpio)
+{
+	static void (*const TRAMPOLINE[CC1200_MAX_RADIOS])(void) = { _irq_radio<0>, _irq_radio<1>, _irq_radio<2>, _irq_radio<3> };
+
+	uint8_t i = 0;
+	while (i < _RADIO_COUNT && _RADIOS[i] != this)
+	{
+		i++;
+	}
+	if (i == _RADIO_COUNT || !ConfigureGpio(gpio, GPIO_MCU_WAKEUP))
+	{
+		return false;
+	}
+
+	if (_IRQ_PIN > PIN_UNUSED)
+	{
+		detachInterrupt(digitalPinToInterrupt(_IRQ_PIN));
+	}
+	_IRQ_PIN = pin;
+	pinMode(pin, INPUT);
+	attachInterrupt(digitalPinToInterrupt(pin), TRAMPOLINE[i], RISING);
+	return true;
+}
+
+// Main-loop service of every radio on the bus: FIFO streams and async operation timeouts. One step per radio
+// per pass, and the radio served first rotates, so a busy radio cannot starve the others. Returns the number
+// of radios with a stream or operation still in progress.
+uint8_t CC1200::ServiceAll(void)
+{
+	uint8_t busy = 0;
+	for (uint8_t n = 0; n < _RADIO_COUNT; n++)
 	{
-		if (len == 1) // Single Read
+		CC1200 *radio = _RADIOS[(_SERVICE_NEXT + n) % _RADIO_COUNT];
+		uint8_t tx = radio->ServiceTxStream();
+		uint8_t rx = radio->ServiceRxStream();
+		radio->ServiceRadio();
+		if (tx == STREAM_ACTIVE || tx == STREAM_DRAINING || rx == STREAM_ACTIVE || radio->RadioBusy())
 		{
-			_spi_transfer(READ_SINGLE | highByte(address)); // 0x2F??
-			_spi_transfer(lowByte(address));
-			buffer[0] = _spi_transfer(0xFF); // Put dummy byte to get the received byte
+			busy++;
 		}
-		else // Burst Read
+	}
+	if (_RADIO_COUNT > 0)
+	{
+		_SERVICE_NEXT = (_SERVICE_NEXT + 1) % _RADIO_COUNT;
+	}
+	return busy;
+}
+
+// Calibrate every channel of a hop set once (FREQ2..0 set by the caller) and store the FS calibration
+// results. Switches FS_AUTOCAL off: from now on Hop() restores the results instead of calibrating.
+// Call in IDLE. Returns the number of channels calibrated.
+uint8_t CC1200::CalibrateHopSet(fsCal_t channels[], uint8_t count)
+{
+	byte settling;
+	_spi_read_register(CC120X_SETTLING_CFG, &settling, 1);
+	settling &= ~0x18; // FS_AUTOCAL [4:3]: Never (manual calibration using SCAL)
+	_spi_write_register(CC120X_SETTLING_CFG, &settling, 1);
+
+	uint8_t i;
+	for (i = 0; i < count; i++)
+	{
+		_spi_write_register(CC120X_FREQ2, channels[i].FREQ, 3);
+		_spi_strobe(CC120X_SCAL);
+		if (!WaitState(MARC_STATE_IDLE))
 		{
-			_spi_transfer(READ_BURST | highByte(address)); // 0x2F??
-			_spi_transfer(lowByte(address));
-			for (uint8_t i = 0; i < len; i++)
-			{
-				buffer[i] = _spi_transfer(0xFF); // Put dummy byte to get the received byte
-			}
+			break;
 		}
+		_spi_read_register(CC120X_FS_CHP, &channels[i].CHP, 1);
+		_spi_read_register(CC120X_FS_VCO4, channels[i].VCO, 3);
 	}
-
-	digitalWrite(_SS_PIN, HIGH); // Pull the SS pin HIGH - Inactive
+	return i;
 }
 
-// SPI Write - Single or Multiple Bytes to Normal/Extended Register space
-void CC1200::_spi_write_register(uint16_t address, uint8_t *buffer, uint8_t len)
+// Switch to a calibrated channel and issue command (CC120X_SRX, CC120X_STX, CC120X_SFSTXON or 0: stay IDLE).
+// Calibration and frequency are written in one CS: FS_CHP and FS_VCO4..2 as single writes, then FREQ2..0 as one
+// burst (a burst runs until CS is released). The synthesizer only settles. TRUE once in RX/FSTXON.
+bool CC1200::Hop(const fsCal_t *channel, uint8_t command)
 {
-	/*
-		NORMAL[0x00-0x2E] or EXTENDED[0x2F00-0x2FFF] space
-	*/
-	bool normSpace = ((address >> 8) == 0x2F) ? false : true;
+	uint32_t start = micros();
+	_spi_strobe(CC120X_SIDLE);
+
+	_spi_select();
+	_spi_transfer(WRITE_SINGLE | highByte(CC120X_FS_CHP));
+	_spi_transfer(lowByte(CC120X_FS_CHP));
+	_spi_transfer(channel->CHP);
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		_spi_transfer(WRITE_SINGLE | highByte(CC120X_FS_VCO4));
+		_spi_transfer(lowByte(CC120X_FS_VCO4) + i);
+		_spi_transfer(channel->VCO[i]);
+	}
+	_spi_transfer(WRITE_BURST | highByte(CC120X_FREQ2));
+	_spi_transfer(lowByte(CC120X_FREQ2));
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		_spi_transfer(channel->FREQ[i]);
+	}
+	_spi_deselect();
 
-	digitalWrite(_SS_PIN, LOW); // Pull the SS pin LOW - Active
-	wait_pin_low(_MISO_PIN); // Wait until MISO pin goes LOW
+	if (_cacheEnabled && _cacheLoaded)
+	{
+		for (uint8_t i = 0; i < 3; i++)
+		{
+			_cache_store(CC120X_FREQ2 + i, channel->FREQ[i], false);
+			_cache_store(CC120X_FS_VCO4 + i, channel->VCO[i], false);
+		}
+	}
 
-	if (normSpace) // Normal Address Space
+	bool ok = true;
+	if (command != 0)
 	{
-		if (len == 1) // Single Write
+		_spi_strobe(command);
+		if (command == CC120X_SRX)
 		{
-			_spi_transfer(WRITE_SINGLE | lowByte(address));
-			_spi_transfer(buffer[0]);
+			ok = WaitState(MARC_STATE_RX);
 		}
-		else // Burst Write
+		else if (command == CC120X_SFSTXON)
 		{
-			_spi_transfer(WRITE_BURST | lowByte(address));
-			for (uint8_t i = 0; i < len; i++)
-			{
-				_spi_transfer(buffer[i]);
-			}
+			ok = WaitState(MARC_STATE_FSTXON);
 		}
 	}
-	else // Extended Address Space
+	_hopLatency = micros() - start;
+	return ok;
+}
+
+// Duration of the last Hop() in microseconds
+uint32_t CC1200::GetHopLatency(void)
+{
+	return _hopLatency;
+}
+
+// Precompute the switch from profile from to profile to: the entries of to (last one wins) whose register is not
+// in from or holds another value there. Stored in storage (size entries) and described by diff. Applying the diff
+// on a radio configured with from has the effect of Configure(to). FALSE if storage is too small.
+bool CC1200::BuildProfileDiff(const registerSetting_t from[], uint8_t fromLen, const registerSetting_t to[], uint8_t toLen, registerSetting_t storage[], uint8_t size, profileDiff_t *diff)
+{
+	diff->SETTINGS = storage;
+	diff->LEN = 0;
+	diff->FLAGS = 0;
+
+	for (uint8_t i = 0; i < toLen; i++)
 	{
-		if (len == 1) // Single Write
+		uint16_t address = to[i].REGISTER;
+		bool superseded = false;
+		for (uint8_t j = i + 1; j < toLen && !superseded; j++)
 		{
-			_spi_transfer(WRITE_SINGLE | highByte(address)); // 0x2F??
-			_spi_transfer(lowByte(address));
-			_spi_transfer(buffer[0]);
+			superseded = (to[j].REGISTER == address);
 		}
-		else // Burst Write
+		if (superseded)
 		{
-			_spi_transfer(WRITE_BURST | highByte(address)); // 0x2F??
-			_spi_transfer(lowByte(address));
-			for (uint8_t i = 0; i < len; i++)
+			continue;
+		}
+
+		int16_t current = -1;
+		for (uint8_t j = 0; j < fromLen; j++)
+		{
+			if (from[j].REGISTER == address)
 			{
-				_spi_transfer(buffer[i]);
+				current = from[j].VALUE;
 			}
 		}
+		if (current == to[i].VALUE)
+		{
+			continue;
+		}
+
+		if (diff->LEN == size)
+		{
+			return false;
+		}
+		storage[diff->LEN++] = to[i];
+		if (address == CC120X_FS_CFG || (address >= CC120X_FREQOFF1 && address <= CC120X_FS_VCO0))
+		{
+			diff->FLAGS |= PROFILE_RECALIBRATE;
+		}
+	}
+	return true;
+}
+
+// Switch profile mid-session: IDLE, the diff written as burst writes (see Configure), calibration if it touches
+// the synthesizer, then command (CC120X_SRX, CC120X_STX, CC120X_SFSTXON or 0: stay IDLE). TRUE once in RX/FSTXON.
+// SCAL is skipped when SETTLING_CFG.FS_AUTOCAL calibrates on the way out of IDLE anyway.
+bool CC1200::SwitchProfile(const profileDiff_t *diff, uint8_t command)
+{
+	_spi_strobe(CC120X_SIDLE);
+
+	bool ok = true;
+	if (diff->LEN > 0)
+	{
+		ok = Configure(diff->SETTINGS, diff->LEN);
+	}
+
+	bool calibrate = (diff->FLAGS & PROFILE_RECALIBRATE);
+	if (calibrate && command != 0)
+	{
+		byte settling;
+		_spi_read_register(CC120X_SETTLING_CFG, &settling, 1);
+		calibrate = (((settling >> 3) & 0x03) != 1); // FS_AUTOCAL [4:3]: 1 = IDLE to RX/TX
+	}
+	if (ok && calibrate)
+	{
+		_spi_strobe(CC120X_SCAL);
+		ok = WaitState(MARC_STATE_IDLE);
+	}
+
+	if (ok && command != 0)
+	{
+		_spi_strobe(command);
+		if (command == CC120X_SRX)
+		{
+			ok = WaitState(MARC_STATE_RX);
+		}
+		else if (command == CC120X_SFSTXON)
+		{
+			ok = WaitState(MARC_STATE_FSTXON);
+		}
+	}
+	return ok;
+}
+
+// Clear channel assessment before TX: mode CCA_* (PKT_CFG2.CCA_MODE), the carrier sense threshold thresholdDbm
+// (AGC_CS_THR, RSSI_OFFSET added as for RSSI readings). Also enables RNDGEN, which seeds the CSMA backoff.
+bool CC1200::ConfigureCca(uint8_t mode, int8_t thresholdDbm)
+{
+	if (mode > CCA_LBT)
+	{
+		return false;
+	}
+
+	byte value;
+	_spi_read_register(CC120X_PKT_CFG2, &value, 1);
+	value = (value & 0xE3) | (mode << 2); // CCA_MODE [4:2]
+	_spi_write_register(CC120X_PKT_CFG2, &value, 1);
+
+	int16_t threshold = (int16_t)thresholdDbm + RSSI_OFFSET;
+	value = (byte)(int8_t)max(min(threshold, (int16_t)127), (int16_t)-128);
+	_spi_write_register(CC120X_AGC_CS_THR, &value, 1);
+
+	value = RNDGEN_EN;
+	_spi_write_register(CC120X_RNDGEN, &value, 1);
+	return true;
+}
+
+// CSMA/CA backoff: before attempt n (0 .. maxBackoffs) wait a random 0 .. 2^BE - 1 slots of slotUs, BE starting
+// at minBe and growing by one per busy channel up to maxBe (<= 7).
+void CC1200::ConfigureBackoff(uint16_t slotUs, uint8_t minBe, uint8_t maxBe, uint8_t maxBackoffs)
+{
+	_csmaSlotUs = slotUs;
+	_csmaMaxBe = min(maxBe, (uint8_t)7);
+	_csmaMinBe = min(minBe, _csmaMaxBe);
+	_csmaMaxBackoffs = min(maxBackoffs, (uint8_t)(CSMA_ATTEMPTS - 1));
+}
+
+// Send frame [Length Address --Payload--] with listen-before-talk and wait until it is on air. The radio listens
+// (RX) until carrier sense is valid; each attempt waits a random backoff, then TX is strobed and the chip only
+// transmits if the channel is clear (see ConfigureCca). A busy channel (TXONCCA_FAILED) widens the backoff.
+// Returns RADIO_OK, RADIO_CHANNEL_BUSY, RADIO_FIFO_ERROR, RADIO_TIMEOUT or RADIO_TOO_LONG (frame does not fit the
+// TX FIFO). Uses MARC_STATUS1: do not combine with DispatchIrq() on the same radio.
+uint8_t CC1200::SendCsma(byte frame[], uint32_t timeoutUs)
+{
+	uint32_t start = micros();
+	_csmaStats.FRAMES++;
+	if (frame[0] >= FIFO_SIZE_BYTES) // frame[0] + 1 bytes must fit the TX FIFO (and a uint8_t length)
+	{
+		_csmaStats.ERRORS++;
+		return RADIO_TOO_LONG;
+	}
+
+	// TX on CCA needs RX with a valid RSSI
+	if (GetStat(StatType::MARC_STATE, 0x1F) != MARC_STATE_RX)
+	{
+		_spi_strobe(CC120X_SRX);
+	}
+	byte rssi0 = 0;
+	while (!(rssi0 & 0x02)) // RSSI0.CARRIER_SENSE_VALID
+	{
+		if (micros() - start >= timeoutUs)
+		{
+			_csmaStats.ERRORS++;
+			_csma_discard();
+			return RADIO_TIMEOUT;
+		}
+		_spi_read_register(CC120X_RSSI0, &rssi0, 1);
+	}
+	_spi_write_register(RADIO_FIFO_ACCESS_STD, frame, frame[0] + 1);
+
+	uint8_t be = _csmaMinBe;
+	for (uint8_t attempt = 0; ; attempt++)
+	{
+		byte random;
+		_spi_read_register(CC120X_RNDGEN, &random, 1);
+		uint8_t slots = random & ((1 << be) - 1);
+		for (uint8_t i = 0; i < slots; i++)
+		{
+			delayMicroseconds(_csmaSlotUs);
+		}
+		_csmaStats.BACKOFF_SLOTS += slots;
+		_csmaStats.BACKOFF_US += (uint32_t)slots * _csmaSlotUs;
+
+		uint8_t result = _csma_attempt(start, timeoutUs);
+		if (result == RADIO_OK)
+		{
+			_csmaStats.SENT++;
+			_csmaStats.SENT_AT[attempt]++;
+			return RADIO_OK;
+		}
+		if (result != RADIO_CHANNEL_BUSY)
+		{
+			_csmaStats.ERRORS++;
+			_csma_discard();
+			return result;
+		}
+
+		_csmaStats.BUSY_AT[attempt]++;
+		if (attempt >= _csmaMaxBackoffs)
+		{
+			_csmaStats.BUSY_DROPS++;
+			_csma_discard();
+			return RADIO_CHANNEL_BUSY;
+		}
+		be = min((uint8_t)(be + 1), _csmaMaxBe);
+	}
+}
+
+// Get CSMA/CA statistics. reset = TRUE clears them after reading.
+csmaStats_t CC1200::GetCsmaStats(bool reset)
+{
+	csmaStats_t stats = _csmaStats;
+	if (reset)
+	{
+		memset(&_csmaStats, 0, sizeof(_csmaStats));
+	}
+	return stats;
+}
+
+// On-air time of a frame of frameBytes [Length Address --Payload--] at the configured symbol rate: preamble,
+// sync word, frame and CRC (PKT_CFG1.CRC_CFG). 0 if the symbol rate is not set. Reads 6 registers.
+uint32_t CC1200::AirTimeUs(uint16_t frameBytes)
+{
+	byte reg[1];
+	_spi_read_register(CC120X_SYNC_CFG1, reg, 1);
+	uint16_t bits = SYNC_BITS[reg[0] >> 5];
+	_spi_read_register(CC120X_PKT_CFG1, reg, 1);
+	bits += (frameBytes + (((reg[0] >> 1) & 0x03) ? 2 : 0)) * 8;
+	return _preamble_us(0) + _preamble_us(bits);
+}
+
+// On-air time of preamble and sync word: from TX start until the receiver detects the sync word (WOR_CAPTURE)
+uint32_t CC1200::SyncTimeUs(void)
+{
+	byte reg;
+	_spi_read_register(CC120X_SYNC_CFG1, &reg, 1);
+	return _preamble_us(0) + _preamble_us(SYNC_BITS[reg >> 5]);
+}
+
+// Set up eWOR sniff mode for a worst-case wake-up latency of latencyUs. The wake-up period must also fit the
+// preamble sent by the peers (preambleBits, 0: this radio's PREAMBLE_CFG1): a wake-up anywhere in the preamble
+// still sees carrier before the sync word. WOR_RES/EVENT0 (WOR_CFG1, WOR_EVENT0) and the RX timeout
+// (RFEND_CFG1.RX_TIME) are written. Returns the period in microseconds, 0 if the preamble is too short.
+uint32_t CC1200::ConfigureSniff(uint32_t latencyUs, uint16_t preambleBits)
+{
+	byte worCfg1;
+	_spi_read_register(CC120X_WOR_CFG1, &worCfg1, 1);
+	uint32_t minRxUs = _preamble_us(SNIFF_SENSE_BITS);
+	uint32_t wakeUs = SNIFF_EVENT1_PERIODS[worCfg1 & 0x07] * (1000000UL / SNIFF_RCOSC_HZ) + SNIFF_SETTLE_US;
+	uint32_t preambleUs = _preamble_us(preambleBits);
+
+	// Wake-up every period, sense for minRxUs: the sensing window must end inside the preamble
+	if (preambleUs <= wakeUs + minRxUs)
+	{
+		return 0;
+	}
+	uint32_t periodUs = min(latencyUs, preambleUs - wakeUs - minRxUs);
+
+	// EVENT0 = period * f_rcosc / 2^(5 * WOR_RES), 16 bits: saturates at the longest period of the largest WOR_RES
+	uint8_t res = 0;
+	uint32_t ticks = periodUs / (1000000UL / SNIFF_RCOSC_HZ);
+	while (res < 3 && (ticks >> (5 * res)) > 0xFFFF)
+	{
+		res++;
+	}
+	uint16_t event0 = min(max(ticks >> (5 * res), (uint32_t)1), (uint32_t)0xFFFF);
+
+	// RX timeout = max(1, EVENT0 >> (RX_TIME + 3)) * 2^(4 * WOR_RES) * 1250 / f_xosc: shortest one >= minRxUs
+	uint8_t rxTime = 0;
+	uint32_t timeoutUs = 0;
+	for (int8_t t = 6; t >= 0; t--)
+	{
+		uint32_t units = max((uint32_t)event0 >> (t + 3), (uint32_t)1) << (4 * res);
+		timeoutUs = (uint32_t)((uint64_t)units * 1250 * 1000000UL / CC1200_FXOSC);
+		if (timeoutUs >= minRxUs)
+		{
+			rxTime = t;
+			break;
+		}
+	}
+
+	byte value[2];
+	worCfg1 = (worCfg1 & 0x3F) | (res << 6); // WOR_RES [7:6]
+	_spi_write_register(CC120X_WOR_CFG1, &worCfg1, 1);
+	value[0] = highByte(event0);
+	value[1] = lowByte(event0);
+	_spi_write_register(CC120X_WOR_EVENT0_MSB, value, 2);
+	_spi_read_register(CC120X_RFEND_CFG1, value, 1);
+	value[0] = (value[0] & ~0x0E) | (rxTime << 1); // RX_TIME [3:1]
+	_spi_write_register(CC120X_RFEND_CFG1, value, 1);
+
+	_sniff_account();
+	_sniffStats.PERIOD_US = ((uint32_t)event0 << (5 * res)) * (1000000UL / SNIFF_RCOSC_HZ);
+	_sniffStats.RX_ON_US = wakeUs + timeoutUs;
+	_sniffStats.PREAMBLE_US = preambleUs;
+	return _sniffStats.PERIOD_US;
+}
+
+// Enter eWOR (SWORRST, SWOR). Packets wake the MCU through the packet/MCU_WAKEUP interrupt as in RX.
+void CC1200::StartSniff(void)
+{
+	_spi_strobe(CC120X_SIDLE);
+	_spi_strobe(CC120X_SWORRST);
+	_spi_strobe(CC120X_SWOR);
+	_sniff_account();
+	_sniffActive = true;
+	_sniffRearm = false;
+	_sniffMark = micros();
+}
+
+// Leave eWOR (IDLE)
+void CC1200::StopSniff(void)
+{
+	_sniff_account();
+	_sniffActive = false;
+	_spi_strobe(CC120X_SIDLE);
+}
+
+// Call from the main loop while sniffing. With DispatchIrq() serving the MCU_WAKEUP pin, eWOR is restarted
+// after a received packet (once the RX FIFO has been read) and after MARC_STATUS1_OUT_EWOR_SYNC_LOST.
+void CC1200::ServiceSniff(void)
+{
+	if (!_sniffActive)
+	{
+		return;
+	}
+	_sniff_account();
+	if (!_sniffRearm)
+	{
+		return;
+	}
+
+	byte queued;
+	_spi_read_register(CC120X_NUM_RXBYTES, &queued, 1);
+	if (queued == 0)
+	{
+		StartSniff();
+	}
+}
+
+// Get the sniff mode timing and energy estimate. reset = TRUE clears the accumulated figures.
+sniffStats_t CC1200::GetSniffStats(bool reset)
+{
+	_sniff_account();
+	sniffStats_t stats = _sniffStats;
+	if (stats.SNIFF_US > 0)
+	{
+		uint32_t on = min(stats.RADIO_ON_US, stats.SNIFF_US);
+		stats.AVG_NA = SNIFF_SLEEP_NA + (uint32_t)((uint64_t)(SNIFF_RX_UA * 1000UL - SNIFF_SLEEP_NA) * on / stats.SNIFF_US);
+	}
+	if (reset)
+	{
+		_sniffStats.SNIFF_US = 0;
+		_sniffStats.RADIO_ON_US = 0;
+		_sniffStats.PACKETS = 0;
+		_sniffStats.SYNC_LOST = 0;
+		_sniffWakeOnUs = 0;
+	}
+	return stats;
+}
+
+// Load the AES-128 key (16 bytes, key[0] first as in FIPS-197). Stays in the chip until reset/power down.
+void CC1200::AesSetKey(const byte key[])
+{
+	_spi_write_register(CC120X_AES_KEY, (uint8_t *)key, AES_BLOCK_SIZE);
+}
+
+// Encrypt one 16-byte block in place with the on-chip engine (AES-128 ECB). FALSE on engine timeout.
+// The engine only encrypts: use CTR or CCM, whose decryption needs the forward cipher only.
+bool CC1200::AesEncrypt(byte block[])
+{
+	_aes_start(block);
+	return _aes_finish(block);
+}
+
+// Encrypt or decrypt (same operation) len bytes in place in CTR mode. counter is the initial counter block
+// and is advanced (big-endian, whole block), so a following call continues the key stream. The next counter
+// block is encrypted by the chip while the current key stream block is applied. FALSE on engine timeout.
+bool CC1200::AesCtr(byte counter[], byte data[], uint16_t len)
+{
+	if (len == 0)
+	{
+		return true;
+	}
+
+	byte stream[AES_BLOCK_SIZE];
+	_aes_start(counter);
+	for (uint16_t pos = 0; pos < len; pos += AES_BLOCK_SIZE)
+	{
+		if (!_aes_finish(stream))
+		{
+			return false;
+		}
+		for (int8_t i = AES_BLOCK_SIZE - 1; i >= 0 && ++counter[i] == 0; i--);
+		if (len - pos > AES_BLOCK_SIZE)
+		{
+			_aes_start(counter); // Runs while this block is combined
+		}
+
+		uint8_t n = min(len - pos, (uint16_t)AES_BLOCK_SIZE);
+		for (uint8_t i = 0; i < n; i++)
+		{
+			data[pos + i] ^= stream[i];
+		}
+	}
+	return true;
+}
+
+// CCM (RFC 3610, 13-byte nonce): encrypt len bytes of data in place and authenticate them together with aad.
+// micLen (4, 6, ... 16) bytes of MIC are written to mic. FALSE on invalid micLen or engine timeout.
+bool CC1200::AesCcmEncrypt(const byte nonce[], const byte aad[], uint8_t aadLen, byte data[], uint8_t len, byte mic[], uint8_t micLen)
+{
+	return _aes_ccm(nonce, aad, aadLen, data, len, mic, micLen, true);
+}
+
+// CCM (RFC 3610, 13-byte nonce): decrypt len bytes of data in place and check the MIC over aad and data.
+// FALSE if the MIC does not match (data is cleared) or on engine timeout.
+bool CC1200::AesCcmDecrypt(const byte nonce[], const byte aad[], uint8_t aadLen, byte data[], uint8_t len, const byte mic[], uint8_t micLen)
+{
+	byte tag[AES_BLOCK_SIZE];
+	if (!_aes_ccm(nonce, aad, aadLen, data, len, tag, micLen, false))
+	{
+		memset(data, 0, len);
+		return false;
+	}
+
+	byte diff = 0;
+	for (uint8_t i = 0; i < micLen; i++)
+	{
+		diff |= tag[i] ^ mic[i];
+	}
+	if (diff != 0)
+	{
+		memset(data, 0, len);
+		return false;
+	}
+	return true;
+}
+
+// Register cache. When enabled, ReadRegister(), WriteRegister(), UpdateRegister() and GetAddress() use a RAM
+// mirror of the configuration registers (normal space and extended 0x2F00-0x2F39). Writes only mark entries
+// dirty until Flush(). Status registers, FIFOs and registers changed by the chip itself (calibration results,
+// RC oscillator calibration, FREQOFF after SAFC) always go to the chip. Submit() bypasses the cache.
+void CC1200::EnableCache(bool enable)
+{
+	if (!enable && _cacheEnabled)
+	{
+		Flush();
+	}
+	_cacheEnabled = enable;
+	_cacheLoaded = false;
+}
+
+// Write dirty cache entries to the chip. Runs of dirty registers go out as burst writes; clean gaps shorter
+// than a header are written along. Returns the number of burst transactions.
+uint8_t CC1200::Flush(void)
+{
+	if (!_cacheEnabled || !_cacheLoaded)
+	{
+		return 0;
+	}
+
+	uint8_t bursts = 0;
+	for (uint8_t space = 0; space < 2; space++)
+	{
+		uint8_t first = space ? 0x2F : 0x00;
+		uint8_t last = space ? CACHE_SIZE : 0x2F;
+		uint8_t gap = space ? 2 : 1; // Header bytes saved by bridging
+		int16_t start = -1, end = -1;
+
+		for (uint8_t i = first; i <= last; i++)
+		{
+			bool cached = (i < last) && _cache_index(space ? (0x2F00 | (i - 0x2F)) : i) >= 0;
+			bool dirty = cached && (_cacheDirty[i >> 3] & (1 << (i & 0x07)));
+			if (dirty)
+			{
+				if (start < 0)
+				{
+					start = i;
+				}
+				end = i;
+			}
+			else if (start >= 0 && (!cached || i - end > gap)) // Never bridge registers the chip changes
+			{
+				uint16_t address = space ? (0x2F00 | (start - 0x2F)) : start;
+				_spi_write_register(address, &_CACHE[start], end - start + 1);
+				bursts++;
+				start = -1;
+			}
+		}
+	}
+	memset(_cacheDirty, 0, sizeof(_cacheDirty));
+	return bursts;
+}
+
+// Streaming TX of a frame of any length from a buffer. See BeginTxStream(producer, ...).
+bool CC1200::BeginTxStream(byte frame[], uint16_t len, int8_t gpio)
+{
+	if (frame == NULL)
+	{
+		return false;
+	}
+	return _tx_stream_begin(NULL, NULL, frame, len, gpio);
+}
+
+// Streaming TX of len bytes (any length) as one packet. Call in IDLE. The packet is sent with fixed packet
+// length, or infinite length switching to fixed when < 256 bytes remain; on air it is identical to a variable
+// length frame when the first byte is len - 1. GPIOx (0..3, optional) is routed to TXFIFO_THR: call
+// ServiceTxStream() on its FALLING edge, or poll it, until it returns STREAM_DONE. FALSE for a NULL producer.
+bool CC1200::BeginTxStream(streamProducer_t producer, void *context, uint16_t len, int8_t gpio)
+{
+	if (producer == NULL)
+	{
+		return false;
+	}
+	return _tx_stream_begin(producer, context, NULL, len, gpio);
+}
+
+// Refill the TX FIFO as it drains. Returns the stream state (STREAM_ACTIVE, DRAINING, DONE or ERROR).
+uint8_t CC1200::ServiceTxStream(void)
+{
+	if (_txStreamState == STREAM_DRAINING)
+	{
+		byte state = GetStat(StatType::MARC_STATE, 0x1F);
+		if (state == MARC_STATE_TX_FIFO_ERR)
+		{
+			_tx_stream_finish(STREAM_ERROR);
+		}
+		else if (state != MARC_STATE_TX && state != MARC_STATE_TX_END && !(state >= MARC_STATE_BIAS_SETTLE && state <= MARC_STATE_ENDCAL))
+		{
+			_tx_stream_finish(STREAM_DONE);
+		}
+	}
+
+	if (_txStreamState != STREAM_ACTIVE)
+	{
+		return _txStreamState;
+	}
+
+	byte queued;
+	_spi_read_register(CC120X_NUM_TXBYTES, &queued, 1);
+	if (queued == 0 && GetStat(StatType::MARC_STATE, 0x1F) == MARC_STATE_TX_FIFO_ERR)
+	{
+		_tx_stream_finish(STREAM_ERROR);
+		return _txStreamState;
+	}
+
+	uint8_t count = min((uint16_t)(FIFO_SIZE_BYTES - queued), _txStreamLeft);
+	_tx_stream_fill(count);
+
+	// Fewer than 256 bytes left on air: fixed length ends the packet at PKT_LEN (modulo 256)
+	if (_txStreamInfinite && (uint16_t)(_txStreamLeft + queued + count) <= 255)
+	{
+		byte value = _txStreamSaved[0] & 0x9F;
+		_spi_write_register(CC120X_PKT_CFG0, &value, 1);
+		_txStreamInfinite = false;
+	}
+
+	if (_txStreamLeft == 0)
+	{
+		_txStreamState = STREAM_DRAINING;
+	}
+	return _txStreamState;
+}
+
+// Streaming RX into a caller-owned ring buffer. The RX FIFO is drained in chunks while a packet is still
+// arriving, so variable length packets up to PKT_LEN (255) bytes fit through the 128-byte FIFO and data rate
+// is limited by the drain latency only. GPIOx (0..3, optional) is routed to RXFIFO_THR_PKT: call
+// ServiceRxStream() on its RISING edge (64 bytes in the FIFO or end of packet), or poll it.
+bool CC1200::BeginRxStream(streamRing_t *ring, int8_t gpio)
+{
+	if (ring == NULL || ring->SIZE < 2 || _rxStreamState == STREAM_ACTIVE)
+	{
+		return false;
+	}
+
+	_rxStreamRing = ring;
+	_rxStreamRing->HEAD = _rxStreamRing->TAIL = 0;
+	_rxStreamGpio = (gpio >= 0 && gpio <= 3) ? gpio : PIN_UNUSED;
+	memset(&_rxStreamStats, 0, sizeof(_rxStreamStats));
+
+	byte value;
+	_spi_read_register(CC120X_PKT_CFG1, &value, 1);
+	_rxStreamStatusLen = (value & 0x01) ? 2 : 0; // APPEND_STATUS: RSSI, CRC_OK | LQI
+
+	// CRC_AUTOFLUSH would flush the tail of a frame already partly drained: bad frames are dropped here instead
+	_spi_read_register(CC120X_FIFO_CFG, &_rxStreamSaved[0], 1);
+	value = STREAM_FIFO_THR;
+	_spi_write_register(CC120X_FIFO_CFG, &value, 1);
+	if (_rxStreamGpio != PIN_UNUSED)
+	{
+		_spi_read_register(CC120X_IOCFG0 - _rxStreamGpio, &_rxStreamSaved[1], 1);
+		value = GPIO_RXFIFO_THR_PKT;
+		_spi_write_register(CC120X_IOCFG0 - _rxStreamGpio, &value, 1);
+	}
+
+	_rxStreamState = STREAM_ACTIVE;
+	_spi_strobe(CC120X_SIDLE);
+	_rx_stream_restart();
+	return true;
+}
+
+// Drain the RX FIFO into the ring. Returns STREAM_ACTIVE, or STREAM_IDLE when no stream is running.
+uint8_t CC1200::ServiceRxStream(void)
+{
+	if (_rxStreamState != STREAM_ACTIVE)
+	{
+		return _rxStreamState;
+	}
+
+	// NUM_RXBYTES, the chip state comes with the header byte
+	_spi_select();
+	byte status = _spi_transfer(READ_SINGLE | highByte(CC120X_NUM_RXBYTES));
+	_spi_transfer(lowByte(CC120X_NUM_RXBYTES));
+	uint8_t queued = _spi_transfer(0x00);
+	_spi_deselect();
+	status &= 0x70;
+
+	if (status == CC120X_STATE_RXFIFO_ERROR)
+	{
+		_rxStreamStats.OVERFLOWS++;
+		INSTR_COUNT(FIFO_RECOVERIES);
+		_rx_stream_restart();
+		return _rxStreamState;
+	}
+
+	if (queued > _rxStreamStats.PEAK_FIFO)
+	{
+		_rxStreamStats.PEAK_FIFO = queued;
+	}
+
+	// Do not empty the FIFO while a packet is arriving, unless the bytes left complete the current frame
+	uint8_t count = queued;
+	if (status == CC120X_STATE_RX && queued != _rxStreamNeed && queued > 0)
+	{
+		count--;
+	}
+	if (count > 0)
+	{
+		_spi_select();
+		_spi_transfer(READ_BURST | RADIO_FIFO_ACCESS_STD);
+		for (uint8_t i = 0; i < count; i++)
+		{
+			_rx_stream_push(_spi_transfer(0x00));
+		}
+		_spi_deselect();
+		_rxStreamStats.BYTES += count;
+		_rxStreamStats.DRAINS++;
+	}
+
+	// Packet ended in IDLE (RXOFF_MODE): back to RX once the FIFO is empty
+	if (status == CC120X_STATE_IDLE && count == queued)
+	{
+		_rx_stream_restart();
+	}
+
+	return _rxStreamState;
+}
+
+// Stop streaming RX. Returns to IDLE and restores FIFO_CFG and the GPIO config. Frames in the ring stay readable.
+void CC1200::EndRxStream(void)
+{
+	if (_rxStreamState != STREAM_ACTIVE)
+	{
+		return;
+	}
+
+	_spi_strobe(CC120X_SIDLE);
+	_spi_strobe(CC120X_SFRX);
+	_spi_write_register(CC120X_FIFO_CFG, &_rxStreamSaved[0], 1);
+	if (_rxStreamGpio != PIN_UNUSED)
+	{
+		_spi_write_register(CC120X_IOCFG0 - _rxStreamGpio, &_rxStreamSaved[1], 1);
+	}
+	_rxStreamState = STREAM_IDLE;
+}
+
+// Take the oldest frame out of the ring. Returns its length [Length Address --Payload-- (RSSI LQI)],
+// or 0 if the ring is empty or the frame is longer than maxLen (it stays in the ring).
+uint16_t CC1200::ReadRxStream(byte frame[], uint16_t maxLen)
+{
+	streamRing_t *ring = _rxStreamRing;
+	if (ring == NULL || ring->TAIL == ring->HEAD)
+	{
+		return 0;
+	}
+
+	uint16_t tail = ring->TAIL;
+	uint16_t len = ring->BUFFER[tail] + 1 + _rxStreamStatusLen;
+	if (len > maxLen)
+	{
+		return 0;
+	}
+
+	for (uint16_t i = 0; i < len; i++)
+	{
+		frame[i] = ring->BUFFER[tail];
+		tail = (tail + 1 < ring->SIZE) ? tail + 1 : 0;
+	}
+	ring->TAIL = tail;
+	return len;
+}
+
+// Get streaming RX statistics. reset = TRUE clears them after reading.
+rxStreamStats_t CC1200::GetRxStreamStats(bool reset)
+{
+	rxStreamStats_t stats = _rxStreamStats;
+	if (reset)
+	{
+		memset(&_rxStreamStats, 0, sizeof(_rxStreamStats));
+	}
+	return stats;
+}
+
+// Continuous streaming by custom frequency modulation: no preamble, sync word or FIFO start/stop. Each CfmTick()
+// moves one sample between buffer and CFM_TX_DATA_IN (direction CFM_TX) or CFM_RX_DATA_OUT (CFM_RX) by a queued
+// transaction, so call it from a timer interrupt at the sample rate. buffer holds 2 * halfLen samples used as a
+// double buffer: when a half is done, ServiceCfm() passes it to handler (TX: refill, RX: consume) while CfmTick()
+// works through the other. TX calls handler for both halves before it starts. Call in IDLE.
+bool CC1200::BeginCfm(uint8_t direction, int8_t buffer[], uint16_t halfLen, cfmHandler_t handler, void *context)
+{
+	if (buffer == NULL || handler == NULL || halfLen == 0 || direction > CFM_RX || _cfmState == STREAM_ACTIVE)
+	{
+		return false;
+	}
+
+	_cfmDirection = direction;
+	_cfmBuffer = buffer;
+	_cfmHalf = halfLen;
+	_cfmHandler = handler;
+	_cfmContext = context;
+	_cfmPos = 0;
+	_cfmDue = 0;
+	_cfmRelease = -1;
+	_cfmService = 0;
+	_cfmSample = 0;
+	memset(&_cfmStats, 0, sizeof(_cfmStats));
+	_cfmStats.PERIOD_MIN_US = 0xFFFFFFFF;
+
+	if (direction == CFM_TX)
+	{
+		handler(buffer, halfLen, context);
+		handler(buffer + halfLen, halfLen, context);
+	}
+	_cfmReady = 0x03;
+
+	// Save the registers the stream takes over
+	_spi_read_register(CC120X_MDMCFG2, &_cfmSaved[0], 1);
+	_spi_read_register(CC120X_PKT_CFG2, &_cfmSaved[1], 1);
+
+	byte value = _cfmSaved[0] | CFM_DATA_EN;
+	_spi_write_register(CC120X_MDMCFG2, &value, 1);
+	value = (_cfmSaved[1] & 0xFC) | PKT_FORMAT_TRANSPARENT;
+	_spi_write_register(CC120X_PKT_CFG2, &value, 1);
+
+	if (direction == CFM_TX)
+	{
+		value = 0; // Carrier frequency until the first sample
+		_spi_write_register(CC120X_CFM_TX_DATA_IN, &value, 1);
+	}
+
+	_cfmTrans.STATE = SPI_TRANS_IDLE;
+	_cfmState = STREAM_ACTIVE;
+	_spi_strobe(direction == CFM_TX ? CC120X_STX : CC120X_SRX);
+	return true;
+}
+
+// Move the next sample. Call from the sample rate timer interrupt. Returns at once.
+void CC1200::CfmTick(void)
+{
+	if (_cfmState != STREAM_ACTIVE)
+	{
+		return;
+	}
+	if (_cfmTrans.STATE == SPI_TRANS_QUEUED || _cfmTrans.STATE == SPI_TRANS_ACTIVE)
+	{
+		_cfmStats.OVERRUNS++;
+		return;
+	}
+
+	uint8_t half = (_cfmPos < _cfmHalf) ? 0 : 1;
+	bool ready = (_cfmReady & (1 << half));
+	if (!ready)
+	{
+		_cfmStats.UNDERRUNS++;
+	}
+
+	int8_t *sample = &_cfmSample;
+	_cfmRelease = -1;
+	if (ready)
+	{
+		if (_cfmDirection == CFM_TX)
+		{
+			_cfmSample = _cfmBuffer[_cfmPos];
+		}
+		else
+		{
+			sample = &_cfmBuffer[_cfmPos];
+		}
+		if (++_cfmPos == _cfmHalf || _cfmPos == 2 * _cfmHalf)
+		{
+			_cfmRelease = half;
+			_cfmPos = (_cfmPos == 2 * _cfmHalf) ? 0 : _cfmPos;
+		}
+	}
+	else if (_cfmDirection == CFM_RX)
+	{
+		return; // No room: the sample is dropped
+	}
+
+	_cfmTrans.TYPE = (_cfmDirection == CFM_TX) ? SPI_TRANS_WRITE : SPI_TRANS_READ;
+	_cfmTrans.ADDRESS = (_cfmDirection == CFM_TX) ? CC120X_CFM_TX_DATA_IN : CC120X_CFM_RX_DATA_OUT;
+	_cfmTrans.BUFFER = (uint8_t *)sample;
+	_cfmTrans.LEN = 1;
+	_cfmTrans.CALLBACK = _cfm_done;
+	_cfmTrans.CONTEXT = this;
+	Submit(&_cfmTrans);
+}
+
+// Pass the completed halves to the handler, oldest first. Call in the main loop. Returns the stream state.
+uint8_t CC1200::ServiceCfm(void)
+{
+	while (_cfmState == STREAM_ACTIVE && (_cfmDue & (1 << _cfmService)))
+	{
+		_cfmHandler(_cfmBuffer + (_cfmService ? _cfmHalf : 0), _cfmHalf, _cfmContext);
+		_cfmStats.HALVES++;
+
+		uint8_t state = CC120X_SPI::EnterCritical();
+		_cfmDue &= ~(1 << _cfmService);
+		_cfmReady |= (1 << _cfmService);
+		CC120X_SPI::ExitCritical(state);
+		_cfmService ^= 1;
+	}
+	return _cfmState;
+}
+
+// Stop streaming. Returns to IDLE and restores MDMCFG2 and PKT_CFG2. Samples not handed over are discarded.
+void CC1200::EndCfm(void)
+{
+	if (_cfmState != STREAM_ACTIVE)
+	{
+		return;
+	}
+
+	_cfmState = STREAM_IDLE; // A sample still on the bus completes before SIDLE gets the bus
+	_spi_strobe(CC120X_SIDLE);
+	_spi_write_register(CC120X_MDMCFG2, &_cfmSaved[0], 1);
+	_spi_write_register(CC120X_PKT_CFG2, &_cfmSaved[1], 1);
+	_spi_strobe(CC120X_SFTX);
+	_spi_strobe(CC120X_SFRX);
+}
+
+// Get streaming CFM statistics. reset = TRUE clears them after reading.
+cfmStats_t CC1200::GetCfmStats(bool reset)
+{
+	uint8_t state = CC120X_SPI::EnterCritical();
+	cfmStats_t stats = _cfmStats;
+	if (reset)
+	{
+		memset(&_cfmStats, 0, sizeof(_cfmStats));
+		_cfmStats.PERIOD_MIN_US = 0xFFFFFFFF;
+	}
+	CC120X_SPI::ExitCritical(state);
+	return stats;
+}
+
+// Queue the received frame. Call from the end-of-packet interrupt (e.g. GPIO2 PKT_SYNC_RXTX falling edge).
+// Returns at once: the frames in the RX FIFO are read one by one by queued SPI transactions, each as its length
+// byte says, and RX is re-entered if the radio went IDLE. A frame still arriving is left in the FIFO (its length
+// byte read) and completed by the next interrupt. An interrupt during the read is served right after it.
+void CC1200::QueueRxFrame(void)
+{
+	uint32_t now = micros();
+	if (_rxQueueBusy)
+	{
+		_rxQueuePending = true;
+		_rxQueuePendingStamp = now;
+		return;
+	}
+
+	_rxQueueBusy = true;
+	_rxQueueStamp = now;
+	_rx_queue_submit(RXQ_CONFIG, SPI_TRANS_READ, CC120X_PKT_CFG1, &_rxQueueCfg, 1);
+}
+
+// Queued frames ready to be processed
+uint8_t CC1200::FramesAvailable(void)
+{
+	return (_rxQueueHead + CC1200_RX_QUEUE_LEN - _rxQueueTail) % CC1200_RX_QUEUE_LEN;
+}
+
+// Oldest queued frame, NULL if none. Stays valid until PopFrame().
+rxFrame_t *CC1200::PeekFrame(void)
+{
+	if (_rxQueueTail == _rxQueueHead)
+	{
+		return NULL;
+	}
+	return &_rxQueue[_rxQueueTail];
+}
+
+// Release the oldest queued frame
+void CC1200::PopFrame(void)
+{
+	if (_rxQueueTail != _rxQueueHead)
+	{
+		_rxQueueTail = (_rxQueueTail + 1) % CC1200_RX_QUEUE_LEN;
+	}
+}
+
+// Get received-frame queue statistics. reset = TRUE clears them after reading.
+rxQueueStats_t CC1200::GetRxQueueStats(bool reset)
+{
+	rxQueueStats_t stats = _rxQueueStats;
+	if (reset)
+	{
+		memset(&_rxQueueStats, 0, sizeof(_rxQueueStats));
+	}
+	return stats;
+}
+
+// Get SPI bus statistics (bytes shifted, CS assertions). reset = TRUE clears the counters after reading.
+spiStats_t CC1200::GetSpiStats(bool reset)
+{
+	spiStats_t stats = CC120X_SPI::Stats;
+	if (reset)
+	{
+		CC120X_SPI::Stats.BYTES = 0;
+		CC120X_SPI::Stats.CS_TOGGLES = 0;
+	}
+	return stats;
+}
+
+#if defined(CC1200_INSTRUMENT)
+// Get the instrumentation counters of all radios on the bus. reset = TRUE clears them after reading.
+instrumentation_t CC1200::GetInstrumentation(bool reset)
+{
+	uint8_t state = CC120X_SPI::EnterCritical();
+	instrumentation_t snapshot = _INSTR;
+	snapshot.SPI_WAIT_SPINS = CC120X_SPI::Stats.WAIT_SPINS;
+	snapshot.READY_WAIT_SPINS = CC120X_SPI::Stats.READY_SPINS;
+	if (reset)
+	{
+		memset(&_INSTR, 0, sizeof(_INSTR));
+		CC120X_SPI::Stats.WAIT_SPINS = 0;
+		CC120X_SPI::Stats.READY_SPINS = 0;
+	}
+	CC120X_SPI::ExitCritical(state);
+	return snapshot;
+}
+
+CC1200::_InstrScope::_InstrScope(uint8_t api)
+{
+	_api = api;
+	_bytes = CC120X_SPI::Stats.BYTES;
+	_cs = CC120X_SPI::Stats.CS_TOGGLES;
+	_strobes = _INSTR.STROBES;
+}
+
+CC1200::_InstrScope::~_InstrScope()
+{
+	apiCounters_t *counters = &_INSTR.API[_api];
+	counters->CALLS++;
+	counters->BYTES += CC120X_SPI::Stats.BYTES - _bytes;
+	counters->CS_TOGGLES += CC120X_SPI::Stats.CS_TOGGLES - _cs;
+	counters->STROBES += _INSTR.STROBES - _strobes;
+}
+
+// Count chip state changes seen in a status byte
+void CC1200::_instr_status(uint8_t status)
+{
+	status &= 0x70;
+	if (status != _INSTR_STATE)
+	{
+		if (_INSTR_STATE != 0xFF)
+		{
+			_INSTR.STATE_CHANGES++;
+		}
+		_INSTR_STATE = status;
+	}
+}
+#endif
+
+// A CFM sample reached the chip (interrupt context): timing, and the half it completed goes to the handler
+void CC1200::_cfm_done(spiTransaction_t *transaction)
+{
+	CC1200 *radio = (CC1200 *)transaction->CONTEXT;
+	cfmStats_t *stats = &radio->_cfmStats;
+	uint32_t now = micros();
+
+	if (stats->SAMPLES == 0)
+	{
+		stats->FIRST_US = now;
+	}
+	else
+	{
+		uint32_t period = now - stats->LAST_US;
+		stats->PERIOD_MIN_US = min(stats->PERIOD_MIN_US, period);
+		stats->PERIOD_MAX_US = max(stats->PERIOD_MAX_US, period);
+	}
+	stats->LAST_US = now;
+	stats->SAMPLES++;
+
+	if (radio->_cfmRelease >= 0)
+	{
+		radio->_cfmReady &= ~(1 << radio->_cfmRelease);
+		radio->_cfmDue |= (1 << radio->_cfmRelease);
+		radio->_cfmRelease = -1;
+	}
+}
+
+// Submit the next step of the asynchronous radio operation
+void CC1200::_radio_submit(uint8_t step, uint8_t type, uint16_t address, uint8_t *buffer, uint8_t len)
+{
+	_radioStep = step;
+	_radioTrans.TYPE = type;
+	_radioTrans.ADDRESS = address;
+	_radioTrans.BUFFER = buffer;
+	_radioTrans.LEN = len;
+	_radioTrans.CALLBACK = _radio_next;
+	_radioTrans.CONTEXT = this;
+	Submit(&_radioTrans);
+}
+
+// End the operation and report it
+void CC1200::_radio_complete(uint8_t result, uint8_t len)
+{
+	radioCallback_t callback = _radioCallback;
+	_radioOp = RADIO_OP_NONE; // Callback may start the next operation
+	if (callback)
+	{
+		callback(result, len, _radioContext);
+	}
+}
+
+// Continue the operation waiting for a packet event with its MARC_STATUS1 (interrupt context)
+void CC1200::_radio_event(uint8_t status)
+{
+	bool tx = (_radioOp == RADIO_OP_TX);
+
+	switch (status)
+	{
+	case MARC_STATUS1_OUT_TX_OK:
+		_radio_complete(RADIO_OK, _radioLen);
+		break;
+	case MARC_STATUS1_OUT_RX_OK:
+		_radio_submit(RADIO_COUNT, SPI_TRANS_READ, CC120X_NUM_RXBYTES, &_radioReg, 1);
+		break;
+	case MARC_STATUS1_OUT_TXONCCA_FAILED: // Channel busy: the radio stays in RX with the frame in the TX FIFO
+		if (tx)
+		{
+			_radio_submit(RADIO_DISCARD, SPI_TRANS_STROBE, CC120X_SIDLE, NULL, 0);
+			break;
+		}
+		_radio_submit(RADIO_STROBE, SPI_TRANS_STROBE, CC120X_SRX, NULL, 0);
+		break;
+	case MARC_STATUS1_OUT_TX_FIFO_UNERR:
+	case MARC_STATUS1_OUT_TX_FIFO_OVERR:
+	case MARC_STATUS1_OUT_RX_FIFO_OVERR:
+	case MARC_STATUS1_OUT_RX_FIFO_UNERR:
+		INSTR_COUNT(FIFO_RECOVERIES);
+		_radio_submit(RADIO_RECOVER, SPI_TRANS_STROBE, tx ? CC120X_SFTX : CC120X_SFRX, NULL, 0);
+		break;
+	default: // Packet dropped (length, address, CRC) or no cause: keep waiting
+		if (tx)
+		{
+			_radioWaiting = true;
+			break;
+		}
+		_radio_submit(RADIO_STROBE, SPI_TRANS_STROBE, CC120X_SRX, NULL, 0);
+		break;
+	}
+}
+
+// Completion of an asynchronous radio step (interrupt context)
+void CC1200::_radio_next(spiTransaction_t *transaction)
+{
+	CC1200 *radio = (CC1200 *)transaction->CONTEXT;
+	bool tx = (radio->_radioOp == RADIO_OP_TX);
+
+	switch (radio->_radioStep)
+	{
+	case RADIO_IDLE:
+		radio->_radio_submit(RADIO_FLUSH, SPI_TRANS_STROBE, tx ? CC120X_SFTX : CC120X_SFRX, NULL, 0);
+		break;
+
+	case RADIO_FLUSH:
+		if (tx)
+		{
+			radio->_radio_submit(RADIO_WRITE, SPI_TRANS_WRITE, RADIO_FIFO_ACCESS_STD, radio->_radioBuffer, radio->_radioLen);
+			break;
+		}
+		radio->_radio_submit(RADIO_STROBE, SPI_TRANS_STROBE, CC120X_SRX, NULL, 0);
+		break;
+
+	case RADIO_WRITE:
+		radio->_radio_submit(RADIO_STROBE, SPI_TRANS_STROBE, CC120X_STX, NULL, 0);
+		break;
+
+	case RADIO_STROBE:
+		radio->_radioWaiting = true;
+		break;
+
+	case RADIO_STATUS:
+		radio->_radio_event(radio->_radioReg);
+		break;
+
+	case RADIO_COUNT:
+		if (radio->_radioReg > radio->_radioLen)
+		{
+			radio->_radio_submit(RADIO_DISCARD, SPI_TRANS_STROBE, CC120X_SIDLE, NULL, 0);
+			break;
+		}
+		radio->_radio_submit(RADIO_READ, SPI_TRANS_READ, RADIO_FIFO_ACCESS_STD, radio->_radioBuffer, radio->_radioReg);
+		break;
+
+	case RADIO_READ:
+		radio->_radio_complete(RADIO_OK, radio->_radioReg);
+		break;
+
+	case RADIO_RECOVER:
+		if (tx)
+		{
+			radio->_radio_complete(RADIO_FIFO_ERROR, 0);
+			break;
+		}
+		radio->_radio_submit(RADIO_STROBE, SPI_TRANS_STROBE, CC120X_SRX, NULL, 0); // Listen again
+		break;
+
+	case RADIO_DISCARD:
+		radio->_radio_submit(RADIO_DISCARDED, SPI_TRANS_STROBE, tx ? CC120X_SFTX : CC120X_SFRX, NULL, 0);
+		break;
+
+	case RADIO_DISCARDED:
+		radio->_radio_complete(tx ? RADIO_CHANNEL_BUSY : RADIO_TOO_LONG, 0);
+		break;
+	}
+}
+
+// MARC_STATUS1 read by DispatchIrq() (interrupt context): one table lookup, then the handler
+void CC1200::_irq_dispatch(spiTransaction_t *transaction)
+{
+	CC1200 *radio = (CC1200 *)transaction->CONTEXT;
+	uint8_t status = radio->_irqStatus;
+	uint8_t cause;
+	if (status & MARC_STATUS1_OUT_RX_OK)
+	{
+		cause = IRQ_RX_OK;
+	}
+	else if (status & MARC_STATUS1_OUT_TX_OK)
+	{
+		cause = IRQ_TX_OK;
+	}
+	else if (status < sizeof(IRQ_CAUSE_TABLE))
+	{
+		cause = IRQ_CAUSE_TABLE[status];
+	}
+	else
+	{
+		cause = IRQ_NONE;
+	}
+
+	if (radio->_radioOp != RADIO_OP_NONE && radio->_radioWaiting && cause != IRQ_NONE)
+	{
+		radio->_radioWaiting = false;
+		radio->_radio_event(status);
+	}
+	if (radio->_sniffActive && (cause == IRQ_RX_OK || cause == IRQ_SYNC_LOST))
+	{
+		if (cause == IRQ_RX_OK)
+		{
+			radio->_sniffStats.PACKETS++;
+		}
+		else
+		{
+			radio->_sniffStats.SYNC_LOST++;
+		}
+		radio->_sniffRearm = true;
+	}
+	if (radio->_irqHandler[cause])
+	{
+		radio->_irqHandler[cause](status, radio->_irqContext[cause]);
+	}
+
+	radio->_irqBusy = false;
+	if (radio->_irqPending)
+	{
+		radio->_irqPending = false;
+		radio->DispatchIrq();
+	}
+}
+
+// Interrupt trampoline of the Nth radio (attachInterrupt() takes no context)
+template <uint8_t N> void CC1200::_irq_radio(void)
+{
+	_RADIOS[N]->DispatchIrq();
+}
+
+// Air time of bits preamble bits (0: PREAMBLE_CFG1.NUM_PREAMBLE) at the configured symbol rate and modulation
+uint32_t CC1200::_preamble_us(uint16_t bits)
+{
+	byte reg[3];
+	if (bits == 0)
+	{
+		_spi_read_register(CC120X_PREAMBLE_CFG1, reg, 1);
+		bits = PREAMBLE_BITS[(reg[0] >> 2) & 0x0F];
+	}
+
+	// Symbol rate: E = SRATE_E, M = SRATE_M (20 bits)
+	_spi_read_register(CC120X_SYMBOL_RATE2, reg, 3);
+	uint8_t e = reg[0] >> 4;
+	uint64_t m = ((uint64_t)(reg[0] & 0x0F) << 16) | ((uint16_t)reg[1] << 8) | reg[2];
+	uint32_t rate = (e == 0) ? (uint32_t)((m * CC1200_FXOSC) >> 38) : (uint32_t)((((1ULL << 20) + m) << e) * CC1200_FXOSC >> 39);
+
+	_spi_read_register(CC120X_MODCFG_DEV_E, reg, 1);
+	uint8_t format = (reg[0] >> 3) & 0x07;
+	uint8_t bitsPerSymbol = (format == 4 || format == 5) ? 2 : 1; // 4-FSK, 4-GFSK
+	if (rate == 0)
+	{
+		return 0;
+	}
+	return (uint32_t)min((uint64_t)bits * 1000000UL / ((uint64_t)rate * bitsPerSymbol), (uint64_t)0xFFFFFFFF);
+}
+
+// Add the time since the last call to the sniff time and its estimated radio-on time
+void CC1200::_sniff_account(void)
+{
+	if (!_sniffActive)
+	{
+		return;
+	}
+	uint32_t now = micros();
+	uint32_t elapsed = now - _sniffMark;
+	_sniffMark = now;
+	_sniffStats.SNIFF_US += elapsed;
+	if (_sniffStats.PERIOD_US > 0)
+	{
+		_sniffWakeOnUs += (uint32_t)((uint64_t)elapsed * _sniffStats.RX_ON_US / _sniffStats.PERIOD_US);
+	}
+	_sniffStats.RADIO_ON_US = _sniffWakeOnUs + (uint32_t)_sniffStats.PACKETS * _sniffStats.PREAMBLE_US;
+}
+
+// One TX on CCA: strobe STX in RX and wait for the verdict in MARC_STATUS1 (cleared on read, so stale causes are
+// read out first). Unrelated RX causes are skipped. RADIO_OK once the frame is sent.
+uint8_t CC1200::_csma_attempt(uint32_t start, uint32_t timeoutUs)
+{
+	byte cause;
+	_spi_read_register(CC120X_MARC_STATUS1, &cause, 1);
+	_spi_strobe(CC120X_STX);
+
+	for (;;)
+	{
+		_spi_read_register(CC120X_MARC_STATUS1, &cause, 1);
+		switch (cause)
+		{
+		case MARC_STATUS1_OUT_TX_OK:
+			return RADIO_OK;
+		case MARC_STATUS1_OUT_TXONCCA_FAILED:
+			return RADIO_CHANNEL_BUSY;
+		case MARC_STATUS1_OUT_TX_FIFO_OVERR:
+		case MARC_STATUS1_OUT_TX_FIFO_UNERR:
+			return RADIO_FIFO_ERROR;
+		}
+		if (micros() - start >= timeoutUs)
+		{
+			return RADIO_TIMEOUT;
+		}
+	}
+}
+
+// Drop the frame of a failed SendCsma() from the TX FIFO. Leaves the radio IDLE.
+void CC1200::_csma_discard(void)
+{
+	_spi_strobe(CC120X_SIDLE);
+	_spi_strobe(CC120X_SFTX);
+}
+
+// Load a block into AES_BUFFER and start the engine
+void CC1200::_aes_start(const byte block[])
+{
+	byte run = 0x01; // AES_RUN
+	_spi_write_register(CC120X_AES_BUFFER, (uint8_t *)block, AES_BLOCK_SIZE);
+	_spi_write_register(CC120X_AES, &run, 1);
+}
+
+// Wait for AES_RUN to clear and read the result. FALSE on timeout.
+bool CC1200::_aes_finish(byte block[])
+{
+	uint32_t start = micros();
+	byte run;
+	for (;;)
+	{
+		_spi_read_register(CC120X_AES, &run, 1);
+		if (!(run & 0x01))
+		{
+			break;
+		}
+		if (micros() - start >= AES_TIMEOUT_US)
+		{
+			return false;
+		}
+	}
+	_spi_read_register(CC120X_AES_BUFFER, block, AES_BLOCK_SIZE);
+	return true;
+}
+
+// CBC-MAC: XOR data into mac from byte fill on, encrypting every full block and a zero-padded last block
+bool CC1200::_aes_absorb(byte mac[], uint8_t fill, const byte data[], uint16_t len)
+{
+	for (uint16_t i = 0; i < len; i++)
+	{
+		mac[fill++] ^= data[i];
+		if (fill == AES_BLOCK_SIZE)
+		{
+			if (!AesEncrypt(mac))
+			{
+				return false;
+			}
+			fill = 0;
+		}
+	}
+	return (fill == 0) || AesEncrypt(mac);
+}
+
+// CCM counter block A_index: flags (L - 1) | nonce | 2-byte index
+void CC1200::_aes_ccm_counter(byte counter[], const byte nonce[], uint8_t index)
+{
+	counter[0] = 0x01;
+	memcpy(&counter[1], nonce, AES_CCM_NONCE_SIZE);
+	counter[14] = 0;
+	counter[15] = index;
+}
+
+// CCM core. Encrypt: MAC over plaintext, then CTR. Decrypt: CTR, then MAC over plaintext. tag = encrypted MIC.
+bool CC1200::_aes_ccm(const byte nonce[], const byte aad[], uint8_t aadLen, byte data[], uint8_t len, byte tag[], uint8_t micLen, bool encrypt)
+{
+	if (micLen < 4 || micLen > AES_BLOCK_SIZE || (micLen & 1))
+	{
+		return false;
+	}
+
+	byte counter[AES_BLOCK_SIZE];
+	if (!encrypt)
+	{
+		_aes_ccm_counter(counter, nonce, 1);
+		if (!AesCtr(counter, data, len))
+		{
+			return false;
+		}
+	}
+
+	byte mac[AES_BLOCK_SIZE];
+	mac[0] = (aadLen ? 0x40 : 0x00) | (((micLen - 2) / 2) << 3) | 0x01; // B0 flags: Adata, M', L - 1
+	memcpy(&mac[1], nonce, AES_CCM_NONCE_SIZE);
+	mac[14] = 0;
+	mac[15] = len;
+	if (!AesEncrypt(mac))
+	{
+		return false;
+	}
+	if (aadLen)
+	{
+		mac[1] ^= aadLen; // 2-byte length prefix, high byte 0
+		if (!_aes_absorb(mac, 2, aad, aadLen))
+		{
+			return false;
+		}
+	}
+	if (!_aes_absorb(mac, 0, data, len))
+	{
+		return false;
+	}
+
+	_aes_ccm_counter(counter, nonce, 0);
+	if (!AesEncrypt(counter))
+	{
+		return false;
+	}
+	for (uint8_t i = 0; i < micLen; i++)
+	{
+		tag[i] = mac[i] ^ counter[i];
+	}
+
+	if (encrypt)
+	{
+		_aes_ccm_counter(counter, nonce, 1);
+		return AesCtr(counter, data, len);
+	}
+	return true;
+}
+
+// Enter a boot phase. Its timeout starts now.
+void CC1200::_boot_phase(uint8_t phase)
+{
+	_bootPhase = phase;
+	_bootPhaseStart = micros();
+}
+
+// Index of a configuration register in a register image [normal 0x00-0x2E | extended 0x2F00-0x2F39], -1 if none
+int8_t CC1200::_register_index(uint16_t address)
+{
+	if (address < 0x2F)
+	{
+		return address;
+	}
+	if ((address >> 8) != 0x2F || lowByte(address) >= CACHE_EXT_SIZE)
+	{
+		return -1;
+	}
+	return 0x2F + lowByte(address);
+}
+
+// Mirror index of a cached register, -1 if not cached
+int8_t CC1200::_cache_index(uint16_t address)
+{
+	switch (address)
+	{
+	case CC120X_RCCAL_FINE:		// RC oscillator calibration
+	case CC120X_RCCAL_COARSE:
+	case CC120X_RCCAL_OFFSET:
+	case CC120X_FREQOFF1:		// SAFC
+	case CC120X_FREQOFF0:
+	case CC120X_FS_CHP:			// FS calibration
+	case CC120X_FS_VCO4:
+	case CC120X_FS_VCO2:
+		return -1;
+	}
+	return _register_index(address);
+}
+
+// Cache enabled and address .. address + len - 1 all cached. Loads the mirror if needed.
+bool CC1200::_cache_covers(uint16_t address, uint8_t len)
+{
+	if (!_cacheEnabled)
+	{
+		return false;
+	}
+	for (uint8_t i = 0; i < len; i++)
+	{
+		if (_cache_index(address + i) < 0)
+		{
+			return false;
+		}
+	}
+	if (!_cacheLoaded)
+	{
+		_cache_load();
+	}
+	return true;
+}
+
+// Fill the mirror from the chip in two bursts
+void CC1200::_cache_load(void)
+{
+	_spi_read_register(0x00, &_CACHE[0], 0x2F);
+	_spi_read_register(0x2F00, &_CACHE[0x2F], CACHE_EXT_SIZE);
+	memset(_cacheDirty, 0, sizeof(_cacheDirty));
+	_cacheLoaded = true;
+}
+
+// Update the mirror. dirty = FALSE: the chip already holds the value.
+void CC1200::_cache_store(uint16_t address, byte value, bool dirty)
+{
+	int8_t index = _cache_index(address);
+	if (index < 0)
+	{
+		return;
+	}
+
+	if (dirty && _CACHE[index] != value)
+	{
+		_cacheDirty[index >> 3] |= (1 << (index & 0x07));
+	}
+	else if (!dirty)
+	{
+		_cacheDirty[index >> 3] &= ~(1 << (index & 0x07));
+	}
+	_CACHE[index] = value;
+}
+
+// Take over the packet registers for a stream from data, or from producer when data is NULL, prefill and start TX
+bool CC1200::_tx_stream_begin(streamProducer_t producer, void *context, const byte *data, uint16_t len, int8_t gpio)
+{
+	if (len == 0 || _txStreamState == STREAM_ACTIVE || _txStreamState == STREAM_DRAINING)
+	{
+		return false;
+	}
+
+	_txStreamProducer = producer;
+	_txStreamContext = context;
+	_txStreamData = data;
+	_txStreamLeft = len;
+	_txStreamInfinite = (len > 256);
+	_txStreamGpio = (gpio >= 0 && gpio <= 3) ? gpio : PIN_UNUSED;
+	_txStreamState = STREAM_ACTIVE;
+
+	// Save the registers the stream takes over
+	_spi_read_register(CC120X_PKT_CFG0, &_txStreamSaved[0], 1);
+	_spi_read_register(CC120X_PKT_LEN, &_txStreamSaved[1], 1);
+	_spi_read_register(CC120X_FIFO_CFG, &_txStreamSaved[2], 1);
+	if (_txStreamGpio != PIN_UNUSED)
+	{
+		_spi_read_register(CC120X_IOCFG0 - _txStreamGpio, &_txStreamSaved[3], 1);
+		byte iocfg = GPIO_TXFIFO_THR;
+		_spi_write_register(CC120X_IOCFG0 - _txStreamGpio, &iocfg, 1);
+	}
+
+	byte value = (_txStreamSaved[2] & FIFO_CFG_CRC_AUTOFLUSH) | STREAM_FIFO_THR;
+	_spi_write_register(CC120X_FIFO_CFG, &value, 1);
+	value = lowByte(len); // Fixed length counts modulo 256 (0 = 256)
+	_spi_write_register(CC120X_PKT_LEN, &value, 1);
+	value = (_txStreamSaved[0] & 0x9F) | (_txStreamInfinite ? 0x40 : 0x00); // LENGTH_CONFIG [6:5]: Infinite / Fixed
+	_spi_write_register(CC120X_PKT_CFG0, &value, 1);
+
+	FlushTxFifo();
+
+	_tx_stream_fill(min(len, (uint16_t)FIFO_SIZE_BYTES)); // Prefill
+	_spi_strobe(CC120X_STX);
+	return true;
+}
+
+// Write count stream bytes to the TX FIFO in one burst
+void CC1200::_tx_stream_fill(uint8_t count)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	_spi_select();
+	_spi_transfer(WRITE_BURST | RADIO_FIFO_ACCESS_STD);
+	if (_txStreamData != NULL)
+	{
+		for (uint8_t i = 0; i < count; i++)
+		{
+			_spi_transfer(*_txStreamData++);
+		}
+	}
+	else
+	{
+		byte chunk[16];
+		uint8_t left = count;
+		while (left > 0)
+		{
+			uint8_t n = _txStreamProducer(chunk, min(left, (uint8_t)sizeof(chunk)), _txStreamContext);
+			if (n == 0)
+			{
+				break; // Producer has nothing now. Rest is requested on the next refill.
+			}
+			for (uint8_t i = 0; i < n; i++)
+			{
+				_spi_transfer(chunk[i]);
+			}
+			left -= n;
+		}
+		count -= left;
+	}
+	_spi_deselect();
+
+	_txStreamLeft -= count;
+}
+
+// Restore the registers taken over by the stream
+void CC1200::_tx_stream_finish(uint8_t state)
+{
+	if (state == STREAM_ERROR)
+	{
+		FlushTxFifo(); // Leaves TX_FIFO_ERR for IDLE
+		INSTR_COUNT(FIFO_RECOVERIES);
+	}
+	_spi_write_register(CC120X_PKT_CFG0, &_txStreamSaved[0], 1);
+	_spi_write_register(CC120X_PKT_LEN, &_txStreamSaved[1], 1);
+	_spi_write_register(CC120X_FIFO_CFG, &_txStreamSaved[2], 1);
+	if (_txStreamGpio != PIN_UNUSED)
+	{
+		_spi_write_register(CC120X_IOCFG0 - _txStreamGpio, &_txStreamSaved[3], 1);
+	}
+	_txStreamState = state;
+}
+
+// Parse one byte drained from the RX FIFO into the ring
+void CC1200::_rx_stream_push(byte value)
+{
+	streamRing_t *ring = _rxStreamRing;
+
+	if (_rxStreamNeed == 0) // Length byte: start of a frame
+	{
+		_rxStreamNeed = value + 1 + _rxStreamStatusLen;
+		_rxStreamWrite = ring->HEAD;
+		_rxStreamDrop = false;
+	}
+
+	if (!_rxStreamDrop)
+	{
+		uint16_t next = (_rxStreamWrite + 1 < ring->SIZE) ? _rxStreamWrite + 1 : 0;
+		if (next == ring->TAIL)
+		{
+			_rxStreamDrop = true;
+			_rxStreamStats.RING_FULL++;
+		}
+		else
+		{
+			ring->BUFFER[_rxStreamWrite] = value;
+			_rxStreamWrite = next;
+		}
+	}
+
+	if (--_rxStreamNeed == 0 && !_rxStreamDrop)
+	{
+		if (_rxStreamStatusLen > 0 && !(value & CC120X_LQI_CRC_OK_BM))
+		{
+			_rxStreamStats.CRC_ERRORS++;
+		}
+		else
+		{
+			ring->HEAD = _rxStreamWrite; // Publish
+			_rxStreamStats.FRAMES++;
+		}
+	}
+}
+
+// Drop the partial frame, flush and re-enter RX
+void CC1200::_rx_stream_restart(void)
+{
+	_rxStreamNeed = 0;
+	_spi_strobe(CC120X_SFRX);
+	_spi_strobe(CC120X_SRX);
+}
+
+// Submit the next step of the received-frame read chain
+void CC1200::_rx_queue_submit(uint8_t step, uint8_t type, uint16_t address, uint8_t *buffer, uint8_t len)
+{
+	_rxQueueStep = step;
+	_rxQueueTrans.TYPE = type;
+	_rxQueueTrans.ADDRESS = address;
+	_rxQueueTrans.BUFFER = buffer;
+	_rxQueueTrans.LEN = len;
+	_rxQueueTrans.CALLBACK = _rx_queue_next;
+	_rxQueueTrans.CONTEXT = this;
+	Submit(&_rxQueueTrans);
+}
+
+// Bytes of the frame in the free slot: length byte, frame, appended status
+uint16_t CC1200::_rx_queue_frame_len(void)
+{
+	return _rxQueue[_rxQueueHead].DATA[0] + 1 + ((_rxQueueCfg & 0x01) ? 2 : 0); // APPEND_STATUS: RSSI, CRC_OK | LQI
+}
+
+// Fill in the metadata of the frame read into the free slot and publish it
+void CC1200::_rx_queue_commit(void)
+{
+	rxFrame_t *frame = &_rxQueue[_rxQueueHead];
+	uint8_t len = frame->DATA[0] + 1;
+	uint8_t statusLen = (_rxQueueCfg & 0x01) ? 2 : 0;
+
+	frame->LEN = len;
+	frame->TARGET = (len > 1) ? frame->DATA[1] : 0;
+	frame->SOURCE = (len > 2) ? frame->DATA[2] : 0;
+	frame->RSSI = statusLen ? (int8_t)frame->DATA[len] : 0;
+	frame->LQI = statusLen ? (frame->DATA[len + 1] & CC120X_LQI_EST_BM) : 0;
+	frame->CRC_OK = statusLen ? (frame->DATA[len + 1] & CC120X_LQI_CRC_OK_BM) != 0 : true;
+	frame->TIMESTAMP = _rxQueueStamp;
+
+	uint8_t head = (_rxQueueHead + 1) % CC1200_RX_QUEUE_LEN;
+	if (head == _rxQueueTail)
+	{
+		_rxQueueStats.DROPPED++; // Slot is overwritten by the next frame
+		return;
+	}
+	_rxQueueHead = head; // Publish
+	_rxQueueStats.FRAMES++;
+}
+
+// Completion of a read chain step (interrupt context)
+void CC1200::_rx_queue_next(spiTransaction_t *transaction)
+{
+	CC1200 *radio = (CC1200 *)transaction->CONTEXT;
+	uint8_t state = transaction->STATUS & 0x70;
+
+	byte *data = radio->_rxQueue[radio->_rxQueueHead].DATA;
+
+	switch (radio->_rxQueueStep)
+	{
+	case RXQ_CONFIG:
+		radio->_rx_queue_submit(RXQ_COUNT, SPI_TRANS_READ, CC120X_NUM_RXBYTES, &radio->_rxQueueNum, 1);
+		return;
+
+	case RXQ_COUNT:
+		if (state == CC120X_STATE_RXFIFO_ERROR)
+		{
+			radio->_rxQueueStats.DISCARDED++;
+			INSTR_COUNT(FIFO_RECOVERIES);
+			radio->_rx_queue_submit(RXQ_FLUSH, SPI_TRANS_STROBE, CC120X_SFRX, NULL, 0);
+			return;
+		}
+		if (radio->_rxQueuePartial)
+		{
+			// Length byte read by an earlier chain: the rest once it has arrived
+			uint8_t rest = radio->_rx_queue_frame_len() - 1;
+			if (radio->_rxQueueNum >= rest)
+			{
+				radio->_rx_queue_submit(RXQ_READ, SPI_TRANS_READ, RADIO_FIFO_ACCESS_STD, &data[1], rest);
+				return;
+			}
+		}
+		else if (radio->_rxQueueNum > 0)
+		{
+			radio->_rx_queue_submit(RXQ_LENGTH, SPI_TRANS_READ, RADIO_FIFO_ACCESS_STD, data, 1);
+			return;
+		}
+		break;
+
+	case RXQ_LENGTH:
+	{
+		uint16_t total = radio->_rx_queue_frame_len();
+		if (total > sizeof(radio->_rxQueue[0].DATA))
+		{
+			radio->_rxQueueStats.DISCARDED++;
+			radio->_rx_queue_submit(RXQ_IDLE, SPI_TRANS_STROBE, CC120X_SIDLE, NULL, 0);
+			return;
+		}
+		if (radio->_rxQueueNum >= total)
+		{
+			radio->_rx_queue_submit(RXQ_READ, SPI_TRANS_READ, RADIO_FIFO_ACCESS_STD, &data[1], total - 1);
+			return;
+		}
+		radio->_rxQueuePartial = true; // Still arriving: its end-of-packet interrupt reads the rest
+		break;
+	}
+
+	case RXQ_READ:
+		radio->_rxQueuePartial = false;
+		radio->_rx_queue_commit();
+		radio->_rx_queue_submit(RXQ_COUNT, SPI_TRANS_READ, CC120X_NUM_RXBYTES, &radio->_rxQueueNum, 1);
+		return; // Next frame in the FIFO
+
+	case RXQ_IDLE:
+		radio->_rx_queue_submit(RXQ_FLUSH, SPI_TRANS_STROBE, CC120X_SFRX, NULL, 0);
+		return;
+
+	case RXQ_FLUSH:
+		radio->_rxQueuePartial = false;
+		radio->_rx_queue_submit(RXQ_RX, SPI_TRANS_STROBE, CC120X_SRX, NULL, 0);
+		return;
+
+	case RXQ_RX:
+		state = CC120X_STATE_RX;
+		break;
+	}
+
+	// Packet ended in IDLE (RXOFF_MODE): back to RX
+	if (state == CC120X_STATE_IDLE)
+	{
+		radio->_rx_queue_submit(RXQ_RX, SPI_TRANS_STROBE, CC120X_SRX, NULL, 0);
+		return;
+	}
+
+	if (radio->_rxQueuePending)
+	{
+		radio->_rxQueuePending = false;
+		radio->_rxQueueStamp = radio->_rxQueuePendingStamp;
+		radio->_rx_queue_submit(RXQ_CONFIG, SPI_TRANS_READ, CC120X_PKT_CFG1, &radio->_rxQueueCfg, 1);
+		return;
+	}
+	radio->_rxQueueBusy = false;
+}
+
+/* SPI Core Methods */
+// Configure SPI
+void CC1200::_spi_begin(void)
+{
+	// Configure this radio's chip select
+	pinMode(_SS_PIN, OUTPUT);
+	digitalWrite(_SS_PIN, HIGH);
+
+	// Shared bus: the first radio sets up the pins and the peripheral. Later radios must not reprogram it,
+	// a queued transaction of another radio may be in flight.
+	if (_SPI_STARTED)
+	{
+		return;
+	}
+	pinMode(_MOSI_PIN, OUTPUT);
+	pinMode(_MISO_PIN, INPUT);
+	pinMode(_SCK_PIN, OUTPUT);
+
+	digitalWrite(_SCK_PIN, HIGH);
+	digitalWrite(_MOSI_PIN, LOW);
+
+	// SPI Configuration (see CC120X_Transport.h)
+	CC120X_SPI::Begin();
+	_SPI_STARTED = true;
+}
+
+// De-configure SPI
+void CC1200::_spi_end(void)
+{
+	// SPI Pin Directions
+	pinMode(_SS_PIN, INPUT);
+	pinMode(_MOSI_PIN, INPUT);
+	pinMode(_MISO_PIN, INPUT);
+	pinMode(_SCK_PIN, INPUT);
+
+	CC120X_SPI::End();
+	_SPI_STARTED = false;
+}
+
+// Take the bus and assert chip select. Waits until the chip is ready (MISO LOW).
+void CC1200::_spi_select(void)
+{
+	_spi_claim();
+	CC120X_SPI::Select(_SS_PIN, _MISO_PIN);
+}
+
+// Release chip select and the bus
+void CC1200::_spi_deselect(void)
+{
+	CC120X_SPI::Deselect(_SS_PIN);
+	_spi_release();
+}
+
+// Sample CHIP_RDYn with the bus held, so SS is not pulled in the middle of a queued transaction
+bool CC1200::_spi_probe(void)
+{
+	_spi_claim();
+	bool ready = CC120X_SPI::Probe(_SS_PIN, _MISO_PIN);
+	_spi_release();
+	return ready;
+}
+
+// Strobe command via SPI
+void CC1200::_spi_strobe(uint8_t command)
+{
+	INSTR_COUNT(STROBES);
+	_spi_select();
+	byte status = _spi_transfer(command);
+	_spi_deselect();
+	INSTR_STATUS(status);
+}
+
+// SPI Single Byte Read/Write
+uint8_t CC1200::_spi_transfer(uint8_t data)
+{
+	return CC120X_SPI::Transfer(data);
+}
+
+// SPI Read - Single or Multiple Bytes from Normal/Extended Register space
+void CC1200::_spi_read_register(uint16_t address, uint8_t *buffer, uint8_t len)
+{
+	spiTransaction_t transaction;
+	_spi_prepare(&transaction, SPI_TRANS_READ, address, buffer, len);
+	_spi_execute(&transaction);
+}
+
+// SPI Write - Single or Multiple Bytes to Normal/Extended Register space
+void CC1200::_spi_write_register(uint16_t address, uint8_t *buffer, uint8_t len)
+{
+	spiTransaction_t transaction;
+	_spi_prepare(&transaction, SPI_TRANS_WRITE, address, buffer, len);
+	_spi_execute(&transaction);
+
+	if (_cacheEnabled && _cacheLoaded && address != RADIO_FIFO_ACCESS_STD)
+	{
+		for (uint8_t i = 0; i < len; i++)
+		{
+			_cache_store(address + i, buffer[i], false); // Keep the mirror coherent with driver writes
+		}
+	}
+}
+
+/* SPI Transaction Engine */
+// Queue a transaction and return immediately. Completion is signalled through transaction->STATE
+// (SPI_TRANS_DONE) and transaction->CALLBACK. FALSE if the transaction is already queued.
+bool CC1200::Submit(spiTransaction_t *transaction)
+{
+	if (transaction->STATE == SPI_TRANS_QUEUED || transaction->STATE == SPI_TRANS_ACTIVE)
+	{
+		return false;
+	}
+
+	_spi_prepare(transaction, transaction->TYPE, transaction->ADDRESS, transaction->BUFFER, transaction->LEN);
+	if (transaction->TYPE == SPI_TRANS_STROBE)
+	{
+		INSTR_COUNT(STROBES);
+	}
+	transaction->_ss = _SS_PIN;
+	transaction->_miso = _MISO_PIN;
+	transaction->STATE = SPI_TRANS_QUEUED;
+
+	uint8_t state = CC120X_SPI::EnterCritical();
+	if (_QUEUE_TAIL)
+	{
+		_QUEUE_TAIL->_next = transaction;
+	}
+	else
+	{
+		_QUEUE_HEAD = transaction;
+	}
+	_QUEUE_TAIL = transaction;
+
+	if (!_BUS_BUSY)
+	{
+		_BUS_BUSY = true;
+		_spi_start(_QUEUE_HEAD);
+	}
+	CC120X_SPI::ExitCritical(state);
+
+	_spi_drain();
+	return true;
+}
+
+// Bus owned by a queued transaction or a blocking call
+bool CC1200::SpiBusy(void)
+{
+	return _BUS_BUSY;
+}
+
+// Advance the active transaction by one byte. Called from the SPI transfer complete interrupt.
+void CC1200::ServiceSpi(void)
+{
+	spiTransaction_t *transaction = _ACTIVE;
+	if (transaction == NULL)
+	{
+		return;
+	}
+
+	if (_spi_step(transaction, CC120X_SPI::Received()))
+	{
+		CC120X_SPI::Start(_spi_next_byte(transaction));
+		return;
+	}
+
+	// Transaction complete
+	CC120X_SPI::DisableInterrupt();
+	CC120X_SPI::Deselect(transaction->_ss);
+	_QUEUE_HEAD = transaction->_next;
+	if (_QUEUE_HEAD == NULL)
+	{
+		_QUEUE_TAIL = NULL;
+	}
+	_ACTIVE = NULL;
+	_BUS_BUSY = false; // Callback may use the bus
+	transaction->STATE = SPI_TRANS_DONE;
+
+	if (transaction->CALLBACK)
+	{
+		transaction->CALLBACK(transaction);
+	}
+
+	uint8_t state = CC120X_SPI::EnterCritical();
+	if (!_BUS_BUSY && _QUEUE_HEAD)
+	{
+		_BUS_BUSY = true;
+		_spi_start(_QUEUE_HEAD);
+	}
+	CC120X_SPI::ExitCritical(state);
+}
+
+// Run a transaction to completion, polling the bus. Waits until queued transactions are done.
+void CC1200::_spi_execute(spiTransaction_t *transaction)
+{
+	transaction->STATE = SPI_TRANS_ACTIVE;
+	_spi_select();
+	uint8_t received;
+	do
+	{
+		received = _spi_transfer(_spi_next_byte(transaction));
+	} while (_spi_step(transaction, received));
+	_spi_deselect();
+	transaction->STATE = SPI_TRANS_DONE;
+}
+
+// Take the bus for a blocking transfer. Do NOT call from an interrupt while a transaction is queued.
+void CC1200::_spi_claim(void)
+{
+	for (;;)
+	{
+		uint8_t state = CC120X_SPI::EnterCritical();
+		if (!_BUS_BUSY)
+		{
+			_BUS_BUSY = true;
+			CC120X_SPI::ExitCritical(state);
+			return;
+		}
+		CC120X_SPI::ExitCritical(state);
+	}
+}
+
+// Give the bus back. Queued transactions start now.
+void CC1200::_spi_release(void)
+{
+	uint8_t state = CC120X_SPI::EnterCritical();
+	if (_QUEUE_HEAD)
+	{
+		_spi_start(_QUEUE_HEAD);
+	}
+	else
+	{
+		_BUS_BUSY = false;
+	}
+	CC120X_SPI::ExitCritical(state);
+
+	_spi_drain();
+}
+
+// Fill in a descriptor. Header is 1 byte (normal space, FIFO, strobe) or 2 bytes (extended space).
+void CC1200::_spi_prepare(spiTransaction_t *transaction, uint8_t type, uint16_t address, uint8_t *buffer, uint8_t len)
+{
+	transaction->TYPE = type;
+	transaction->ADDRESS = address;
+	transaction->BUFFER = buffer;
+	transaction->LEN = (type == SPI_TRANS_STROBE) ? 0 : len;
+	transaction->_next = NULL;
+	transaction->_pos = 0;
+	transaction->_hdr = (type != SPI_TRANS_STROBE && (address >> 8) == 0x2F) ? 2 : 1;
+}
+
+// Select the chip and shift the first byte. The bus must be owned (_BUS_BUSY).
+void CC1200::_spi_start(spiTransaction_t *transaction)
+{
+	_ACTIVE = transaction;
+	transaction->STATE = SPI_TRANS_ACTIVE;
+	CC120X_SPI::Select(transaction->_ss, transaction->_miso);
+	CC120X_SPI::EnableInterrupt();
+	CC120X_SPI::Start(_spi_next_byte(transaction));
+}
+
+// Transports without a transfer complete interrupt: run queued transactions now
+void CC1200::_spi_drain(void)
+{
+	if (CC120X_SPI::INTERRUPTS || _DRAINING)
+	{
+		return;
+	}
+
+	_DRAINING = true;
+	while (_ACTIVE)
+	{
+		ServiceSpi();
+	}
+	_DRAINING = false;
+}
+
+// Byte to shift at the current position: header (R/W, burst, address) then data or dummy bytes
+uint8_t CC1200::_spi_next_byte(spiTransaction_t *transaction)
+{
+	uint16_t pos = transaction->_pos;
+
+	if (pos == 0)
+	{
+		if (transaction->TYPE == SPI_TRANS_STROBE)
+		{
+			return lowByte(transaction->ADDRESS);
+		}
+
+		uint8_t access;
+		if (transaction->TYPE == SPI_TRANS_READ)
+		{
+			access = (transaction->LEN > 1) ? READ_BURST : READ_SINGLE;
+		}
+		else
+		{
+			access = (transaction->LEN > 1) ? WRITE_BURST : WRITE_SINGLE;
+		}
+		return access | ((transaction->_hdr == 2) ? highByte(transaction->ADDRESS) : lowByte(transaction->ADDRESS)); // 0x2F??
+	}
+
+	if (pos < transaction->_hdr)
+	{
+		return lowByte(transaction->ADDRESS);
+	}
+
+	return (transaction->TYPE == SPI_TRANS_WRITE) ? transaction->BUFFER[pos - transaction->_hdr] : 0xFF; // Put dummy byte to get the received byte
+}
+
+// Consume the byte received at the current position. Returns TRUE while bytes remain.
+bool CC1200::_spi_step(spiTransaction_t *transaction, uint8_t received)
+{
+	uint16_t pos = transaction->_pos;
+
+	if (pos == 0)
+	{
+		transaction->STATUS = received;
+		INSTR_STATUS(received);
+	}
+	else if (pos >= transaction->_hdr && transaction->TYPE == SPI_TRANS_READ)
+	{
+		transaction->BUFFER[pos - transaction->_hdr] = received;
 	}
 
-	digitalWrite(_SS_PIN, HIGH); // Pull the SS pin HIGH - Inactive
+	transaction->_pos = ++pos;
+	return pos < transaction->_hdr + transaction->LEN;
 }
@@ -33,18 +33,272 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #if defined(ARDUINO) && ARDUINO >= 100
 	#include "Arduino.h"
-#else
+#elif defined(ARDUINO)
 	#include "WProgram.h"
+#else
+	#include "CC120X_Host.h"	// Host (non-Arduino) build
 #endif
 
+// Hot-path instrumentation: per-API SPI cost, wait-loop spins, FIFO recoveries and chip state changes.
+// Compiled out unless CC1200_INSTRUMENT is defined here or in the build flags (-DCC1200_INSTRUMENT).
+//#define CC1200_INSTRUMENT
+
 // Libraries
 #include "CC120X_Settings.h"
 #include "CC120X_Misc.h"
+#include "CC120X_Transport.h"
 
 // Defines
 #define PIN_UNUSED				-1		// Unused Pin defination
 #define BROADCAST_ADDRESS000	0x00	// Broadcast addresse 0
 #define BROADCAST_ADDRESS255	0xFF	// Broadcast addresse 255
+#define RSSI_OFFSET				0x30	// RSSI Offset (to be deducted), dec = 48
+
+// Asynchronous radio operations (SendAsync / StartReceive)
+#define RADIO_TIMEOUT_US		100000	// Default SendAsync() timeout
+#define RADIO_OK				0		// Completion results
+#define RADIO_TIMEOUT			1		// No packet event in time. Radio put to IDLE.
+#define RADIO_FIFO_ERROR		2		// TX FIFO underflow (FIFO flushed)
+#define RADIO_TOO_LONG			3		// Received frame longer than the buffer (FIFO flushed), frame to send over the FIFO
+#define RADIO_CHANNEL_BUSY		4		// SendCsma(): channel busy after the last backoff, SendAsync(): TXONCCA_FAILED (FIFO flushed)
+
+#if defined(CC1200_INSTRUMENT)
+// Instrumented public methods
+#define INSTR_CONFIGURE			0
+#define INSTR_GET_STAT			1
+#define INSTR_READ_RX_FIFO		2
+#define INSTR_WRITE_TX_FIFO		3
+#define INSTR_UPDATE_REGISTER	4
+#define INSTR_APIS				5
+
+// SPI cost of one public method, inclusive of the methods it calls
+typedef struct ApiCounters
+{
+	uint32_t CALLS;
+	uint32_t BYTES;							// SPI bytes shifted
+	uint32_t CS_TOGGLES;					// Chip-select assertions
+	uint32_t STROBES;						// Command strobes
+} apiCounters_t;
+
+// Instrumentation snapshot (all radios on the bus)
+typedef struct Instrumentation
+{
+	apiCounters_t API[INSTR_APIS];			// Indexed by INSTR_*
+	uint32_t STROBES;						// Command strobes, blocking and queued
+	uint32_t SPI_WAIT_SPINS;				// wait_spi() loop iterations (byte not yet shifted)
+	uint32_t READY_WAIT_SPINS;				// CHIP_RDYn (MISO) wait iterations on chip select
+	uint32_t FIFO_RECOVERIES;				// TX/RX FIFO errors flushed (ResolveFifoErr, streams, queue, async)
+	uint32_t STATE_CHANGES;					// Chip state (status byte [6:4]) changes seen on the bus
+} instrumentation_t;
+#endif
+
+// Completion of SendAsync()/StartReceive(). len: frame bytes sent/received [Length Address --Payload-- (RSSI LQI)].
+typedef void (*radioCallback_t)(uint8_t result, uint8_t len, void *context);
+
+// Interrupt causes routed by DispatchIrq() (from MARC_STATUS1)
+#define IRQ_NONE				0		// No cause latched
+#define IRQ_TX_OK				1		// Packet sent
+#define IRQ_RX_OK				2		// Packet received (in the RX FIFO)
+#define IRQ_CRC_DROP			3		// Packet dropped: CRC error
+#define IRQ_ADDRESS_DROP		4		// Packet dropped: address filter
+#define IRQ_LENGTH_DROP			5		// Packet dropped: longer than PKT_LEN
+#define IRQ_RX_TIMEOUT			6		// RX timeout (RFEND_CFG1.RX_TIME)
+#define IRQ_RX_TERM				7		// RX terminated on carrier sense / PQT
+#define IRQ_SYNC_LOST			8		// eWOR sync lost
+#define IRQ_TX_FIFO_ERROR		9		// TX FIFO overflow/underflow
+#define IRQ_RX_FIFO_ERROR		10		// RX FIFO overflow/underflow
+#define IRQ_CCA_FAILED			11		// TX on CCA failed: channel busy
+#define IRQ_CAUSES				12
+
+// Interrupt cause handler. status: MARC_STATUS1 as read (MARC_STATUS1_OUT_*).
+typedef void (*irqHandler_t)(uint8_t status, void *context);
+
+// Boot (readiness polling instead of fixed delays)
+#define BOOT_TIMEOUT_US			20000	// Bound per boot phase: chip ready, IDLE, RX
+#define BOOT_RESET_PULSE_US		100		// RESET_N LOW time of a hardware reset
+#define BOOT_RESET				0		// Async fast start phases (ServiceFastStart)
+#define BOOT_WAIT_READY			1
+#define BOOT_CONFIGURE			2
+#define BOOT_WAIT_IDLE			3
+#define BOOT_WAIT_RX			4
+#define BOOT_DONE				5		// Final phases from here on
+#define BOOT_TIMEOUT			6
+#define BOOT_FAILED				7		// Configure() did not read back
+
+// Boot timing, measured from Init() / FastStart() / BeginFastStart()
+typedef struct BootStats
+{
+	uint32_t READY_US;						// CHIP_RDYn LOW after reset
+	uint32_t IDLE_US;						// Configured and IDLE
+	uint32_t RX_US;							// In RX. 0 if not requested.
+} bootStats_t;
+
+// Wake-on-Radio sniff mode (see ConfigureSniff)
+#define CC1200_FXOSC			40000000UL	// Crystal frequency (CC1200EMK)
+#define SNIFF_RCOSC_HZ			40000	// Calibrated RC oscillator (WOR timer)
+#define SNIFF_SETTLE_US			75		// XOSC stable to RX (no calibration)
+#define SNIFF_SENSE_BITS		16		// Shortest RX per wake-up, in preamble bits (RSSI / carrier sense valid)
+#define SNIFF_RX_UA				19000	// Current in RX (typ.), uA
+#define SNIFF_SLEEP_NA			500		// Current in SLEEP with the RC oscillator running (typ.), nA
+
+// Sniff mode timing and energy estimate. Radio-on time is an upper bound: RX runs to the timeout on every
+// wake-up, while carrier-sense termination (RFEND_CFG0) usually ends it earlier.
+typedef struct SniffStats
+{
+	uint32_t PERIOD_US;						// Wake-up period (WOR EVENT0)
+	uint32_t RX_ON_US;						// Radio on per wake-up: XOSC start, settling, RX timeout
+	uint32_t PREAMBLE_US;					// Preamble the period was fitted to
+	uint32_t SNIFF_US;						// Time spent in sniff mode
+	uint32_t RADIO_ON_US;					// Estimated radio-on time (wake-ups and received packets)
+	uint32_t AVG_NA;						// Estimated average current over SNIFF_US, nA
+	uint16_t PACKETS;						// Packets received while sniffing
+	uint16_t SYNC_LOST;						// MARC_STATUS1_OUT_EWOR_SYNC_LOST events (eWOR restarted)
+} sniffStats_t;
+
+// Scatter-gather TX: one payload piece written to the TX FIFO in place (see WriteTxFifo)
+typedef struct TxSegment
+{
+	const byte *DATA;
+	uint8_t LEN;
+} txSegment_t;
+
+// Channel hopping: frequency synthesizer calibration of one channel (see CalibrateHopSet)
+typedef struct FsCal
+{
+	byte FREQ[3];							// FREQ2, FREQ1, FREQ0. Set by the caller.
+	byte CHP;								// FS_CHP. Filled by CalibrateHopSet().
+	byte VCO[3];							// FS_VCO4, FS_VCO3, FS_VCO2. Filled by CalibrateHopSet().
+} fsCal_t;
+
+// Register Cache (RAM mirror of the configuration registers)
+#define CACHE_EXT_SIZE			0x3A	// Extended space 0x2F00-0x2F39 (IF_MIX_CFG .. PA_CFG3)
+#define CACHE_SIZE				(0x2F + CACHE_EXT_SIZE)	// + Normal space 0x00-0x2E (IOCFG3 .. PKT_LEN)
+
+// Streaming States (packets longer than the FIFO)
+#define STREAM_IDLE				0		// No stream
+#define STREAM_ACTIVE			1		// Moving data between buffer and FIFO
+#define STREAM_DRAINING			2		// TX: all bytes in FIFO, packet on air
+#define STREAM_DONE				3		// Packet complete, registers restored
+#define STREAM_ERROR			4		// FIFO under/overflow. FIFO flushed, registers restored.
+#define STREAM_FIFO_THR			63		// FIFO_CFG.FIFO_THR while streaming: TX refill below 64, RX drain from 64 bytes
+
+// Streaming TX data source. Fill up to maxLen bytes into buffer and return the amount written.
+typedef uint8_t (*streamProducer_t)(byte buffer[], uint8_t maxLen, void *context);
+
+// Caller-owned ring buffer of received frames [Length Address --Payload-- (RSSI LQI)]. Only complete frames
+// are published (HEAD); the consumer advances TAIL. One byte stays free to tell full from empty.
+typedef struct StreamRing
+{
+	byte *BUFFER;
+	uint16_t SIZE;
+	volatile uint16_t HEAD;					// Written by the driver
+	volatile uint16_t TAIL;					// Written by the consumer
+} streamRing_t;
+
+// Streaming RX accounting
+typedef struct RxStreamStats
+{
+	uint32_t FRAMES;						// Frames published to the ring
+	uint32_t BYTES;							// Bytes drained from the RX FIFO
+	uint32_t DRAINS;						// FIFO burst reads
+	uint32_t OVERFLOWS;						// RX FIFO overflows (RX_FIFO_ERR)
+	uint32_t RING_FULL;						// Frames dropped for lack of room in the ring
+	uint32_t CRC_ERRORS;					// Frames dropped with CRC_OK = 0
+	uint8_t PEAK_FIFO;						// Highest NUM_RXBYTES seen (headroom = 128 - PEAK_FIFO)
+} rxStreamStats_t;
+
+// Listen-before-talk: clear channel assessment (PKT_CFG2.CCA_MODE) and CSMA/CA backoff (see SendCsma)
+#define CCA_ALWAYS				0		// Always clear (TX strobe never blocked)
+#define CCA_RSSI				1		// Clear while RSSI is below AGC_CS_THR
+#define CCA_NOT_RECEIVING		2		// Clear unless a packet is being received
+#define CCA_RSSI_NOT_RECEIVING	3		// Both of the above
+#define CCA_LBT					4		// RSSI below AGC_CS_THR, ETSI LBT timing
+#define RNDGEN_EN				0x80	// RNDGEN: random number generator enable
+#define CSMA_SLOT_US			320		// Backoff slot (CCA + RX/TX turnaround with margin)
+#define CSMA_MIN_BE				3		// Backoff exponent of the first attempt: 0..2^BE-1 slots
+#define CSMA_MAX_BE				5		// Largest backoff exponent (max. 7: RNDGEN has 7 random bits)
+#define CSMA_MAX_BACKOFFS		4		// Busy channel assessments before a frame is given up
+#define CSMA_ATTEMPTS			(CSMA_MAX_BACKOFFS + 1)
+
+// CSMA/CA accounting. Index n of the per-attempt arrays is the (n + 1)th channel assessment of a frame.
+typedef struct CsmaStats
+{
+	uint32_t FRAMES;						// SendCsma() calls
+	uint32_t SENT;							// Frames sent
+	uint32_t BUSY_DROPS;					// Frames given up: channel busy at every attempt
+	uint32_t ERRORS;						// Frames lost to timeouts or TX FIFO errors
+	uint32_t BACKOFF_SLOTS;					// Random backoff slots waited
+	uint32_t BACKOFF_US;					// Time spent in backoff
+	uint16_t BUSY_AT[CSMA_ATTEMPTS];		// Channel found busy (TXONCCA_FAILED) at attempt n
+	uint16_t SENT_AT[CSMA_ATTEMPTS];		// Frames sent at attempt n
+} csmaStats_t;
+
+// PHY profile switching: the registers of a target profile that differ from the current one (see BuildProfileDiff)
+#define PROFILE_RECALIBRATE		0x01	// Diff touches the frequency synthesizer (FS_CFG, FREQOFF .. FS_VCO0): SCAL
+
+typedef struct ProfileDiff
+{
+	registerSetting_t *SETTINGS;			// Target values, in caller storage
+	uint8_t LEN;
+	uint8_t FLAGS;							// PROFILE_RECALIBRATE
+} profileDiff_t;
+
+// Continuous streaming by custom frequency modulation (see BeginCfm): one sample per CfmTick()
+#define CFM_TX					0		// Samples written to CFM_TX_DATA_IN
+#define CFM_RX					1		// Samples read from CFM_RX_DATA_OUT
+#define CFM_DATA_EN				0x01	// MDMCFG2.CFM_DATA_EN
+#define PKT_FORMAT_TRANSPARENT	0x03	// PKT_CFG2.PKT_FORMAT: transparent serial mode (packet engine and FIFOs off)
+
+// Double buffer half due in the main loop: TX fills, RX consumes len samples
+typedef void (*cfmHandler_t)(int8_t samples[], uint16_t len, void *context);
+
+// Streaming CFM accounting. Sustained rate = (SAMPLES - 1) / (LAST_US - FIRST_US), jitter = PERIOD_MAX_US - PERIOD_MIN_US.
+typedef struct CfmStats
+{
+	uint32_t SAMPLES;						// Samples written to / read from the chip
+	uint32_t HALVES;						// Buffer halves passed to the handler
+	uint32_t UNDERRUNS;						// Half not serviced in time. TX: last sample held, RX: sample dropped.
+	uint32_t OVERRUNS;						// CfmTick() while the previous sample was still on the bus (skipped)
+	uint32_t FIRST_US, LAST_US;				// micros() when the first / last sample reached the chip
+	uint32_t PERIOD_MIN_US, PERIOD_MAX_US;	// Shortest / longest time between samples reaching the chip
+} cfmStats_t;
+
+// On-chip AES-128 engine (encryption only: block, CTR, CCM)
+#define AES_BLOCK_SIZE			16
+#define AES_TIMEOUT_US			1000	// Longest wait for AES.AES_RUN to clear
+#define AES_CCM_NONCE_SIZE		13		// CCM nonce with a 2-byte length field (RFC 3610, L = 2)
+
+// Radios sharing one SPI bus (see AttachIrq / ServiceAll)
+#define CC1200_MAX_RADIOS		4		// Registered by Init(). One interrupt trampoline each.
+
+// Received-frame queue (filled from the packet interrupt, see QueueRxFrame)
+#ifndef CC1200_RX_QUEUE_LEN
+#define CC1200_RX_QUEUE_LEN		4		// Queue slots. One is kept free: holds CC1200_RX_QUEUE_LEN - 1 frames.
+#endif
+#ifndef CC1200_RX_FRAME_MAX
+#define CC1200_RX_FRAME_MAX		64		// Largest queued frame [Length Address --Payload--]
+#endif
+
+// Received frame with metadata
+typedef struct RxFrame
+{
+	uint8_t LEN;							// Frame bytes in DATA [Length Address --Payload--]
+	uint8_t TARGET;							// Target address (DATA[1])
+	uint8_t SOURCE;							// Source address (DATA[2])
+	int8_t RSSI;							// Appended RSSI byte. 0 without APPEND_STATUS.
+	uint8_t LQI;							// Appended LQI estimate (CC120X_LQI_EST_BM)
+	bool CRC_OK;							// Appended CRC_OK (CC120X_LQI_CRC_OK_BM). TRUE without APPEND_STATUS.
+	uint32_t TIMESTAMP;						// micros() at the end-of-packet interrupt
+	byte DATA[CC1200_RX_FRAME_MAX + 2];		// Frame + appended status bytes
+} rxFrame_t;
+
+// Received-frame queue accounting
+typedef struct RxQueueStats
+{
+	uint32_t FRAMES;						// Frames queued
+	uint32_t DROPPED;						// Frames lost: queue full
+	uint32_t DISCARDED;						// FIFO contents flushed: oversize/malformed frame or RX FIFO error
+} rxQueueStats_t;
 
 // State/Status Types
 enum StatType
@@ -60,7 +314,6 @@ enum StatType
 // Macros
 #define higherByte(w) ((uint8_t) ((w) >> 16))		// Higher Byte (2nd highest)
 #define highestByte(w) ((uint8_t) ((w) >> 24))		// Highest Byte
-#define wait_spi()  while(!(SPSR & _BV(SPIF)))		// Wait until SPI operation is terminated
 #define wait_pin_low(pin) while(digitalRead(pin))	// Wait until pin goes LOW
 #define wait_pin_high(pin) while(!digitalRead(pin))	// Wait until pin goes HIGH
 
@@ -69,10 +322,10 @@ class CC1200
 public:
 	void Init(void);
 	void Init(uint8_t SS_PIN, uint8_t MOSI_PIN, uint8_t MISO_PIN, uint8_t SCK_PIN, int8_t RESET_PIN);
-	void Configure(const registerSetting_t settings[], uint8_t len);
+	bool Configure(const registerSetting_t settings[], uint8_t len);
 	byte GetStat(StatType sType, byte keepBits = 0xFF, int8_t shiftLR = 0);
 	void Strobe(uint8_t command);
-	void Reset(bool HWreset = true);
+	bool Reset(bool HWreset = true);
 	void Idle(void);
 	void PowerDown(void);
 	void Transmit(void);
@@ -87,18 +340,261 @@ public:
 	void UpdateRegister(uint16_t address, byte updateBits);
 	uint8_t ReadRxFifo(byte readBuffer[]);
 	void WriteTxFifo(byte writeBuffer[], uint8_t len);	
+	uint8_t WriteTxFifo(uint8_t target, uint8_t source, const txSegment_t segments[], uint8_t count);
+	bool BeginTxStream(byte frame[], uint16_t len, int8_t gpio = PIN_UNUSED);
+	bool BeginTxStream(streamProducer_t producer, void *context, uint16_t len, int8_t gpio = PIN_UNUSED);
+	uint8_t ServiceTxStream(void);
+	bool BeginRxStream(streamRing_t *ring, int8_t gpio = PIN_UNUSED);
+	uint8_t ServiceRxStream(void);
+	void EndRxStream(void);
+	uint16_t ReadRxStream(byte frame[], uint16_t maxLen);
+	rxStreamStats_t GetRxStreamStats(bool reset = false);
+	bool BeginCfm(uint8_t direction, int8_t buffer[], uint16_t halfLen, cfmHandler_t handler, void *context = NULL);
+	void CfmTick(void);
+	uint8_t ServiceCfm(void);
+	void EndCfm(void);
+	cfmStats_t GetCfmStats(bool reset = false);
+	void QueueRxFrame(void);
+	uint8_t FramesAvailable(void);
+	rxFrame_t *PeekFrame(void);
+	void PopFrame(void);
+	rxQueueStats_t GetRxQueueStats(bool reset = false);
+	bool WaitReady(uint32_t timeoutUs = BOOT_TIMEOUT_US);
+	bool WaitState(uint8_t marcState, uint32_t timeoutUs = BOOT_TIMEOUT_US);
+	bool FastStart(const registerSetting_t settings[], uint8_t len, bool rx = false);
+	void BeginFastStart(const registerSetting_t settings[], uint8_t len, bool rx = false);
+	uint8_t ServiceFastStart(uint16_t budgetUs);
+	bootStats_t GetBootStats(void);
+	bool SendAsync(byte frame[], radioCallback_t callback, void *context = NULL, uint32_t timeoutUs = RADIO_TIMEOUT_US);
+	bool StartReceive(byte buffer[], uint8_t maxLen, radioCallback_t callback, void *context = NULL, uint32_t timeoutUs = 0);
+	void RadioIrq(void);
+	void ServiceRadio(void);
+	bool RadioBusy(void);
+	bool ConfigureGpio(uint8_t gpio, uint8_t signal);
+	void OnIrq(uint8_t cause, irqHandler_t handler, void *context = NULL);
+	void DispatchIrq(void);
+	bool AttachIrq(uint8_t pin, uint8_t gpio = 0);
+	static uint8_t ServiceAll(void);
+	uint8_t CalibrateHopSet(fsCal_t channels[], uint8_t count);
+	bool Hop(const fsCal_t *channel, uint8_t command = CC120X_SRX);
+	uint32_t GetHopLatency(void);
+	bool ConfigureCca(uint8_t mode, int8_t thresholdDbm);
+	void ConfigureBackoff(uint16_t slotUs = CSMA_SLOT_US, uint8_t minBe = CSMA_MIN_BE, uint8_t maxBe = CSMA_MAX_BE, uint8_t maxBackoffs = CSMA_MAX_BACKOFFS);
+	uint8_t SendCsma(byte frame[], uint32_t timeoutUs = RADIO_TIMEOUT_US);
+	csmaStats_t GetCsmaStats(bool reset = false);
+	uint32_t AirTimeUs(uint16_t frameBytes);
+	uint32_t SyncTimeUs(void);
+	static bool BuildProfileDiff(const registerSetting_t from[], uint8_t fromLen, const registerSetting_t to[], uint8_t toLen, registerSetting_t storage[], uint8_t size, profileDiff_t *diff);
+	bool SwitchProfile(const profileDiff_t *diff, uint8_t command = CC120X_SRX);
+	uint32_t ConfigureSniff(uint32_t latencyUs, uint16_t preambleBits = 0);
+	void StartSniff(void);
+	void StopSniff(void);
+	void ServiceSniff(void);
+	sniffStats_t GetSniffStats(bool reset = false);
+	void AesSetKey(const byte key[]);
+	bool AesEncrypt(byte block[]);
+	bool AesCtr(byte counter[], byte data[], uint16_t len);
+	bool AesCcmEncrypt(const byte nonce[], const byte aad[], uint8_t aadLen, byte data[], uint8_t len, byte mic[], uint8_t micLen);
+	bool AesCcmDecrypt(const byte nonce[], const byte aad[], uint8_t aadLen, byte data[], uint8_t len, const byte mic[], uint8_t micLen);
+	void EnableCache(bool enable = true);
+	uint8_t Flush(void);
+	spiStats_t GetSpiStats(bool reset = false);
+	bool Submit(spiTransaction_t *transaction);
+	bool SpiBusy(void);
+	static void ServiceSpi(void);
+#if defined(CC1200_INSTRUMENT)
+	static instrumentation_t GetInstrumentation(bool reset = false);
+#endif
 
 private:	
-	uint8_t _RESET_PIN;
+	int8_t _RESET_PIN;
 	uint8_t _SS_PIN, _MOSI_PIN, _MISO_PIN, _SCK_PIN;
 	uint8_t _DEVICE_ADDRESS = BROADCAST_ADDRESS000; // Broadcast Address: 0x00 and/or 0xFF
+	int8_t _IRQ_PIN = PIN_UNUSED;
+
+	static CC1200 *_RADIOS[CC1200_MAX_RADIOS];	// Instances on the bus, in Init() order
+	static uint8_t _RADIO_COUNT;
+	static uint8_t _SERVICE_NEXT;				// ServiceAll(): radio served first in the next pass
+	static bool _SPI_STARTED;					// Peripheral and shared pins set up by the first Init()
+
+	template <uint8_t N> static void _irq_radio(void);
+
+#if defined(CC1200_INSTRUMENT)
+	static instrumentation_t _INSTR;
+	static uint8_t _INSTR_STATE;			// Last chip state seen
+
+	// Books the SPI traffic between construction and destruction to one public method
+	class _InstrScope
+	{
+	public:
+		_InstrScope(uint8_t api);
+		~_InstrScope();
+	private:
+		uint8_t _api;
+		uint32_t _bytes, _cs, _strobes;
+	};
+	static void _instr_status(uint8_t status);
+#endif
+
+	// Asynchronous radio operation
+	volatile uint8_t _radioOp = 0;			// RADIO_OP_* (RADIO_OP_NONE)
+	volatile bool _radioWaiting = false;	// Strobed, waiting for the packet interrupt
+	uint8_t _radioStep;
+	spiTransaction_t _radioTrans;			// Descriptor reused by every step
+	byte _radioReg;							// MARC_STATUS1 / NUM_RXBYTES
+	byte *_radioBuffer;
+	uint8_t _radioLen;						// TX: frame bytes. RX: buffer size.
+	radioCallback_t _radioCallback = NULL;
+	void *_radioContext = NULL;
+	uint32_t _radioStart, _radioTimeout;
+
+	// Interrupt cause dispatcher
+	irqHandler_t _irqHandler[IRQ_CAUSES] = {};
+	void *_irqContext[IRQ_CAUSES] = {};
+	spiTransaction_t _irqTrans;
+	byte _irqStatus;						// MARC_STATUS1
+	volatile bool _irqBusy = false, _irqPending = false;
+
+	// Boot
+	uint32_t _bootStart, _bootPhaseStart;
+	bootStats_t _bootStats;
+	uint8_t _bootPhase = BOOT_DONE;
+	const registerSetting_t *_bootSettings;
+	uint8_t _bootLen;
+	bool _bootRx;
+
+	uint32_t _hopLatency;					// Last Hop(): SIDLE to target state (us)
+
+	// CSMA/CA
+	uint16_t _csmaSlotUs = CSMA_SLOT_US;
+	uint8_t _csmaMinBe = CSMA_MIN_BE;
+	uint8_t _csmaMaxBe = CSMA_MAX_BE;
+	uint8_t _csmaMaxBackoffs = CSMA_MAX_BACKOFFS;
+	csmaStats_t _csmaStats;
+
+	// Sniff mode
+	bool _sniffActive = false;
+	volatile bool _sniffRearm;				// Packet received / sync lost: restart eWOR from ServiceSniff()
+	uint32_t _sniffMark;					// Sniff time accounted up to here
+	uint32_t _sniffWakeOnUs;				// Radio-on time of the wake-ups in SNIFF_US
+	sniffStats_t _sniffStats;
+
+	// Register cache
+	bool _cacheEnabled = false;
+	bool _cacheLoaded;						// Mirror matches the chip (cleared by reset)
+	byte _CACHE[CACHE_SIZE];
+	byte _cacheDirty[(CACHE_SIZE + 7) / 8];
+
+	// Streaming TX
+	uint8_t _txStreamState = STREAM_IDLE;
+	const byte *_txStreamData;
+	streamProducer_t _txStreamProducer;
+	void *_txStreamContext;
+	uint16_t _txStreamLeft;					// Bytes not yet written to the TX FIFO
+	bool _txStreamInfinite;					// Infinite packet length until < 256 bytes remain
+	int8_t _txStreamGpio;
+	byte _txStreamSaved[4];					// PKT_CFG0, PKT_LEN, FIFO_CFG, IOCFGx
+
+	// Streaming RX
+	uint8_t _rxStreamState = STREAM_IDLE;
+	streamRing_t *_rxStreamRing;
+	uint16_t _rxStreamWrite;				// Write cursor of the frame being received (published at its end)
+	uint16_t _rxStreamNeed;					// Bytes left of the current frame. 0: next byte is a length byte.
+	bool _rxStreamDrop;						// Current frame does not fit in the ring
+	uint8_t _rxStreamStatusLen;				// 2 with PKT_CFG1.APPEND_STATUS
+	int8_t _rxStreamGpio;
+	byte _rxStreamSaved[2];					// FIFO_CFG, IOCFGx
+	rxStreamStats_t _rxStreamStats;
+
+	// Streaming CFM (double buffer: CfmTick() works through one half while ServiceCfm() hands the other over)
+	uint8_t _cfmState = STREAM_IDLE;
+	uint8_t _cfmDirection;
+	int8_t *_cfmBuffer;
+	uint16_t _cfmHalf;						// Samples per half
+	uint16_t _cfmPos;						// Next sample (0 .. 2 * _cfmHalf - 1)
+	volatile uint8_t _cfmReady;				// Bit per half: owned by CfmTick() (TX: filled, RX: free)
+	volatile uint8_t _cfmDue;				// Bit per half: owned by the handler
+	int8_t _cfmRelease;						// Half completed by the sample on the bus, -1: none
+	uint8_t _cfmService;					// Half the handler gets next
+	cfmHandler_t _cfmHandler;
+	void *_cfmContext;
+	int8_t _cfmSample;						// TX: sample on the bus. RX: sink for dropped samples.
+	spiTransaction_t _cfmTrans;
+	byte _cfmSaved[2];						// MDMCFG2, PKT_CFG2
+	cfmStats_t _cfmStats;
+
+	// Received-frame queue (single producer: packet interrupt, single consumer: main loop)
+	rxFrame_t _rxQueue[CC1200_RX_QUEUE_LEN];
+	volatile uint8_t _rxQueueHead = 0, _rxQueueTail = 0;
+	spiTransaction_t _rxQueueTrans;			// Descriptor reused by every step of the read chain
+	uint8_t _rxQueueStep;
+	uint8_t _rxQueueNum;					// NUM_RXBYTES
+	uint8_t _rxQueueCfg;					// PKT_CFG1 at the start of the chain
+	bool _rxQueuePartial = false;			// Length byte of the frame in the free slot read, the rest not yet
+	volatile bool _rxQueueBusy = false, _rxQueuePending = false;
+	uint32_t _rxQueueStamp, _rxQueuePendingStamp;
+	rxQueueStats_t _rxQueueStats = {};
+
+	void _radio_submit(uint8_t step, uint8_t type, uint16_t address, uint8_t *buffer, uint8_t len);
+	void _radio_complete(uint8_t result, uint8_t len);
+	void _radio_event(uint8_t status);
+	static void _radio_next(spiTransaction_t *transaction);
+	static void _irq_dispatch(spiTransaction_t *transaction);
+
+	void _boot_phase(uint8_t phase);
+
+	uint8_t _csma_attempt(uint32_t start, uint32_t timeoutUs);
+	void _csma_discard(void);
+
+	uint32_t _preamble_us(uint16_t bits);
+	void _sniff_account(void);
+
+	void _aes_start(const byte block[]);
+	bool _aes_finish(byte block[]);
+	bool _aes_absorb(byte mac[], uint8_t fill, const byte data[], uint16_t len);
+	static void _aes_ccm_counter(byte counter[], const byte nonce[], uint8_t index);
+	bool _aes_ccm(const byte nonce[], const byte aad[], uint8_t aadLen, byte data[], uint8_t len, byte tag[], uint8_t micLen, bool encrypt);
+
+	static int8_t _register_index(uint16_t address);
+	static int8_t _cache_index(uint16_t address);
+	bool _cache_covers(uint16_t address, uint8_t len);
+	void _cache_load(void);
+	void _cache_store(uint16_t address, byte value, bool dirty);
+
+	bool _tx_stream_begin(streamProducer_t producer, void *context, const byte *data, uint16_t len, int8_t gpio);
+	void _tx_stream_fill(uint8_t count);
+	void _tx_stream_finish(uint8_t state);
+	void _rx_stream_push(byte value);
+	void _rx_stream_restart(void);
+	static void _cfm_done(spiTransaction_t *transaction);
+	void _rx_queue_submit(uint8_t step, uint8_t type, uint16_t address, uint8_t *buffer, uint8_t len);
+	uint16_t _rx_queue_frame_len(void);
+	void _rx_queue_commit(void);
+	static void _rx_queue_next(spiTransaction_t *transaction);
+
+	static spiTransaction_t *volatile _QUEUE_HEAD;	// Transaction engine (shared by all instances on the bus)
+	static spiTransaction_t *volatile _QUEUE_TAIL;
+	static spiTransaction_t *volatile _ACTIVE;
+	static volatile bool _BUS_BUSY;
+	static bool _DRAINING;
 
 	void _spi_begin(void);
 	void _spi_end(void);
+	void _spi_select(void);
+	void _spi_deselect(void);
+	bool _spi_probe(void);
 	void _spi_strobe(uint8_t command);
 	uint8_t _spi_transfer(uint8_t data);
 	void _spi_read_register(uint16_t address, uint8_t *buffer, uint8_t len);
 	void _spi_write_register(uint16_t address, uint8_t *buffer, uint8_t len);
+	void _spi_execute(spiTransaction_t *transaction);
+	void _spi_claim(void);
+	static void _spi_release(void);
+	static void _spi_prepare(spiTransaction_t *transaction, uint8_t type, uint16_t address, uint8_t *buffer, uint8_t len);
+	static void _spi_start(spiTransaction_t *transaction);
+	static void _spi_drain(void);
+	static uint8_t _spi_next_byte(spiTransaction_t *transaction);
+	static bool _spi_step(spiTransaction_t *transaction, uint8_t received);
 };
 
 extern CC1200 cc1200; 
@@ -0,0 +1,310 @@
+/*
+
+Copyright (c) 2018 Md Abdullah AL IMRAN | alimran.mdabdullah@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ 1. Redistributions of source code must retain the above copyright
+	notice, this list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright
+	notice, this list of conditions and the following disclaimer in the
+	documentation and/or other materials provided with the distribution.
+ 3. The name of the author may not be used to endorse or promote products
+	derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "CC120X_Aggregate.h"
+
+CC1200Aggregator::CC1200Aggregator(CC1200 &radio, uint8_t address) : _radio(radio), _address(address)
+{
+	_frameMax = AGG_FRAME_MAX - 1;
+	_deliver = NULL;
+	_deliverContext = NULL;
+	_transmit = NULL;
+	_transmitContext = NULL;
+	memset(_QUEUES, 0, sizeof(_QUEUES));
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+// Take the frame limit from PKT_LEN (call after Configure()). deliver receives every message of the frames handed to
+// Receive(). FALSE if PKT_LEN leaves no room for a message: Send() then rejects all.
+bool CC1200Aggregator::Begin(aggDeliver_t deliver, void *context)
+{
+	_deliver = deliver;
+	_deliverContext = context;
+
+	byte pktLen;
+	_radio.ReadRegister(CC120X_PKT_LEN, &pktLen, 1);
+	_frameMax = min(pktLen, (byte)(AGG_FRAME_MAX - 1));
+	if (_frameMax <= AGG_FRAME_HEADER)
+	{
+		_frameMax = 0;
+		return false;
+	}
+	return true;
+}
+
+// Send frames through transmit instead of WriteTxFifo() + STX (NULL: back to the default)
+void CC1200Aggregator::SetTransmit(aggTransmit_t transmit, void *context)
+{
+	_transmit = transmit;
+	_transmitContext = context;
+}
+
+// Longest message: a frame holding it alone. 0 if PKT_LEN is too small.
+uint8_t CC1200Aggregator::MaxMessage(void)
+{
+	return (_frameMax > AGG_FRAME_HEADER) ? _frameMax - AGG_FRAME_HEADER : 0;
+}
+
+// Queue 1 .. MaxMessage() bytes for target, on air within deadlineUs (AGG_URGENT: now). The data is copied. FALSE
+// if the message is too long, the target table is full or its frame is full and the radio busy (call Service()
+// and try again).
+bool CC1200Aggregator::Send(uint8_t target, const byte data[], uint8_t len, uint32_t deadlineUs)
+{
+	aggQueue_t *queue = _queue(target);
+	if (len == 0 || len > MaxMessage() || queue == NULL)
+	{
+		_stats.REJECTED++;
+		return false;
+	}
+	if (queue->COUNT > 0 && queue->FRAME[0] + 1 + len > _frameMax && !_flush(queue, &_stats.FLUSH_FULL))
+	{
+		_stats.REJECTED++;
+		return false;
+	}
+
+	uint32_t dueAt = micros() + deadlineUs;
+	if (queue->COUNT == 0)
+	{
+		queue->TARGET = target;
+		queue->URGENT = false;
+		queue->DUE_AT = dueAt;
+		queue->FRAME[0] = AGG_FRAME_HEADER - 1;
+		queue->FRAME[1] = target;
+		queue->FRAME[2] = _address;
+		queue->FRAME[3] = AGG_FRAME;
+	}
+	else if ((int32_t)(dueAt - queue->DUE_AT) < 0)
+	{
+		queue->DUE_AT = dueAt;
+	}
+
+	byte *end = &queue->FRAME[queue->FRAME[0] + 1];
+	end[0] = len;
+	memcpy(&end[1], data, len);
+	queue->FRAME[0] += 1 + len;
+	queue->COUNT++;
+
+	if (deadlineUs == AGG_URGENT)
+	{
+		queue->URGENT = true;
+		_flush(queue, &_stats.FLUSH_URGENT);
+	}
+	else if (_full(queue))
+	{
+		_flush(queue, &_stats.FLUSH_FULL);
+	}
+	return true;
+}
+
+// Send all frames now, as far as the radio takes them. Returns the messages still queued.
+uint8_t CC1200Aggregator::Flush(void)
+{
+	for (uint8_t i = 0; i < AGG_TARGETS; i++)
+	{
+		_QUEUES[i].URGENT = true;
+	}
+	return Service();
+}
+
+// Call in the main loop: sends the frames that are full, urgent or due. Returns the messages still queued.
+uint8_t CC1200Aggregator::Service(void)
+{
+	uint32_t now = micros();
+	bool ready = true;
+	uint8_t pending = 0;
+	for (uint8_t i = 0; i < AGG_TARGETS; i++)
+	{
+		aggQueue_t *queue = &_QUEUES[i];
+		if (queue->COUNT == 0)
+		{
+			continue;
+		}
+
+		uint32_t *reason = NULL;
+		if (queue->URGENT)
+		{
+			reason = &_stats.FLUSH_URGENT;
+		}
+		else if (_full(queue))
+		{
+			reason = &_stats.FLUSH_FULL;
+		}
+		else if ((int32_t)(now - queue->DUE_AT) >= 0)
+		{
+			reason = &_stats.FLUSH_DEADLINE;
+		}
+		if (reason != NULL && ready)
+		{
+			ready = _flush(queue, reason);
+		}
+		pending += queue->COUNT;
+	}
+	return pending;
+}
+
+// Hand over a frame from the received-frame queue. FALSE if it is not an aggregated frame for this node.
+bool CC1200Aggregator::Receive(const rxFrame_t *frame)
+{
+	if (!frame->CRC_OK || frame->LEN < AGG_FRAME_HEADER || frame->DATA[0] + 1 != frame->LEN)
+	{
+		return false;
+	}
+	return Receive(frame->DATA, frame->LEN);
+}
+
+// Hand over a frame as read by ReadRxFifo(), with or without the appended status bytes (len = Length + 3 or
+// Length + 1). Its messages go to the deliver callback in order, pointing into frame. FALSE if it is not an
+// aggregated frame for this node (or broadcast) or failed CRC.
+bool CC1200Aggregator::Receive(const byte frame[], uint8_t len)
+{
+	if (len < AGG_FRAME_HEADER || len < frame[0] + 1 || frame[0] + 1 < AGG_FRAME_HEADER || frame[3] != AGG_FRAME)
+	{
+		return false;
+	}
+	if (frame[1] != _address && frame[1] != BROADCAST_ADDRESS000 && frame[1] != BROADCAST_ADDRESS255)
+	{
+		return false;
+	}
+	if (len == frame[0] + 3 && !(frame[len - 1] & CC120X_LQI_CRC_OK_BM))
+	{
+		return false;
+	}
+
+	// Walk the sub-headers first: a malformed frame delivers nothing
+	uint16_t end = frame[0] + 1;
+	uint16_t pos;
+	for (pos = AGG_FRAME_HEADER; pos < end; pos += 1 + frame[pos])
+	{
+		if (frame[pos] == 0 || pos + 1 + frame[pos] > end)
+		{
+			_stats.MALFORMED++;
+			return true;
+		}
+	}
+
+	_stats.FRAMES_RECEIVED++;
+	for (pos = AGG_FRAME_HEADER; pos < end; pos += 1 + frame[pos])
+	{
+		_stats.MESSAGES_RECEIVED++;
+		if (_deliver != NULL)
+		{
+			_deliver(frame[2], &frame[pos + 1], frame[pos], _deliverContext);
+		}
+	}
+	return true;
+}
+
+// Statistics since Begin() or the last reset. reset = TRUE clears the counters after reading.
+aggStats_t CC1200Aggregator::GetStats(bool reset)
+{
+	aggStats_t stats = _stats;
+	if (reset)
+	{
+		memset(&_stats, 0, sizeof(_stats));
+	}
+	return stats;
+}
+
+/* Private Helpers */
+
+// Frame being filled for target, or a free one. NULL if all are taken by other targets.
+aggQueue_t *CC1200Aggregator::_queue(uint8_t target)
+{
+	aggQueue_t *free = NULL;
+	for (uint8_t i = 0; i < AGG_TARGETS; i++)
+	{
+		if (_QUEUES[i].COUNT == 0)
+		{
+			if (free == NULL)
+			{
+				free = &_QUEUES[i];
+			}
+		}
+		else if (_QUEUES[i].TARGET == target)
+		{
+			return &_QUEUES[i];
+		}
+	}
+	return free;
+}
+
+// No room for a sub-header and AGG_MESSAGE_MIN bytes
+bool CC1200Aggregator::_full(const aggQueue_t *queue)
+{
+	return (queue->FRAME[0] + 1 + AGG_MESSAGE_MIN > _frameMax);
+}
+
+// Hand the frame to the transmit hook or the TX FIFO and count it under reason. FALSE if the radio is busy.
+bool CC1200Aggregator::_flush(aggQueue_t *queue, uint32_t *reason)
+{
+	if (_transmit != NULL)
+	{
+		if (!_transmit(queue->FRAME, _transmitContext))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		if (!_radio_ready())
+		{
+			return false;
+		}
+		_radio.WriteTxFifo(queue->FRAME, queue->FRAME[0]);
+		_radio.Transmit();
+	}
+
+	(*reason)++;
+	_stats.FRAMES_SENT++;
+	_stats.MESSAGES_SENT += queue->COUNT;
+	_stats.MESSAGE_BYTES += queue->FRAME[0] - (AGG_FRAME_HEADER - 1) - queue->COUNT;
+	_stats.FRAME_BYTES += queue->FRAME[0] + 1;
+	queue->COUNT = 0;
+	queue->URGENT = false;
+	return true;
+}
+
+// IDLE or RX with nothing left in the TX FIFO: the previous frame is on air no more
+bool CC1200Aggregator::_radio_ready(void)
+{
+	byte state = _radio.GetStat(StatType::MARC_STATE, 0x1F);
+	if (state == MARC_STATE_TX_FIFO_ERR || state == MARC_STATE_RX_FIFO_ERR)
+	{
+		_radio.ResolveFifoErr();
+		return false;
+	}
+	if (state != MARC_STATE_IDLE && state != MARC_STATE_RX)
+	{
+		return false;
+	}
+	byte txBytes;
+	_radio.ReadRegister(CC120X_NUM_TXBYTES, &txBytes, 1);
+	return (txBytes == 0);
+}
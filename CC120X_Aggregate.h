@@ -0,0 +1,107 @@
+#ifndef _CC120X_AGGREGATE_H
+#define _CC120X_AGGREGATE_H
+
+/* =====================================================================================================================
+												MESSAGE AGGREGATION
+  ===================================================================================================================== */
+// Packs small application messages for the same target into one frame, so preamble, sync word, length, addresses
+// and CRC are paid once per frame instead of once per message. Every target has one frame being filled. It is
+// sent when the next message does not fit, when it is full, when the earliest deadline of its messages has
+// passed, or at once for AGG_URGENT messages. The receiver splits a frame into its messages in place: the
+// callback gets pointers into the received frame, nothing is copied. The object belongs to the caller, e.g.
+//
+//   CC1200Aggregator agg(cc1200, THIS_NODE);
+//   agg.Begin(onMessage);
+//   ...
+//   agg.Send(TARG_NODE, reading, sizeof(reading), 200000);	// on air within 200 ms
+//   agg.Send(TARG_NODE, alarm, sizeof(alarm), AGG_URGENT);		// on air now, with what is queued
+//   rxFrame_t *frame = cc1200.PeekFrame();
+//   if (frame) { agg.Receive(frame); cc1200.PopFrame(); }
+//   agg.Service();                                             // deadlines
+//
+// Frame: [Length Target Source AGG_FRAME | Len1 --Message1-- | Len2 --Message2-- | ...]
+//
+// A frame is at most PKT_LEN and AGG_FRAME_MAX bytes. By default it goes out with WriteTxFifo() and STX when the
+// radio is in IDLE or RX with an empty TX FIFO; a transmit hook (e.g. SendCsma) takes its place.
+
+#include "CC1200.h"
+
+#ifndef AGG_TARGETS
+#define AGG_TARGETS			2			// Targets with a frame being filled
+#endif
+#ifndef AGG_FRAME_MAX
+#define AGG_FRAME_MAX		CC1200_RX_FRAME_MAX	// Frame bytes [Length Target Source ...]: fits the received-frame queue
+#endif
+#ifndef AGG_DEADLINE_US
+#define AGG_DEADLINE_US		100000UL	// Default longest wait of a message for more to share its frame
+#endif
+#define AGG_URGENT			0			// Deadline: send now
+#define AGG_FRAME_HEADER	4			// [Length Target Source AGG_FRAME]
+#define AGG_MESSAGE_MIN		4			// Frame counts as full when less than a sub-header and this much is left
+#define AGG_FRAME			0xA6		// Frame type byte (frame[3])
+
+// Message received: data points into the frame and is valid during the call only
+typedef void (*aggDeliver_t)(uint8_t source, const byte data[], uint8_t len, void *context);
+
+// Frame transmission instead of WriteTxFifo() + STX. TRUE if the frame was written to the TX FIFO.
+typedef bool (*aggTransmit_t)(byte frame[], void *context);
+
+// Aggregation accounting
+typedef struct AggStats
+{
+	uint32_t MESSAGES_SENT;					// Messages in frames sent
+	uint32_t FRAMES_SENT;
+	uint32_t MESSAGE_BYTES;					// Message bytes sent (sub-headers excluded)
+	uint32_t FRAME_BYTES;					// Frame bytes sent (length byte included, CRC excluded)
+	uint32_t FLUSH_FULL;					// Frames sent: next message did not fit or frame full
+	uint32_t FLUSH_DEADLINE;				// Frames sent: deadline passed
+	uint32_t FLUSH_URGENT;					// Frames sent: AGG_URGENT message or Flush()
+	uint32_t REJECTED;						// Send() FALSE: too long, target table full, radio busy
+	uint32_t MESSAGES_RECEIVED;
+	uint32_t FRAMES_RECEIVED;
+	uint32_t MALFORMED;						// Received frames with sub-headers past the frame end (dropped)
+} aggStats_t;
+
+// Frame being filled for one target
+typedef struct AggQueue
+{
+	uint8_t TARGET;
+	uint8_t COUNT;							// Messages in FRAME. 0: free.
+	bool URGENT;							// Send as soon as the radio takes it
+	uint32_t DUE_AT;						// micros(): earliest deadline of the messages
+	byte FRAME[AGG_FRAME_MAX];
+} aggQueue_t;
+
+class CC1200Aggregator
+{
+public:
+	CC1200Aggregator(CC1200 &radio, uint8_t address);
+	bool Begin(aggDeliver_t deliver, void *context = NULL);
+	void SetTransmit(aggTransmit_t transmit, void *context = NULL);
+	uint8_t MaxMessage(void);
+
+	bool Send(uint8_t target, const byte data[], uint8_t len, uint32_t deadlineUs = AGG_DEADLINE_US);
+	uint8_t Flush(void);
+	uint8_t Service(void);
+	bool Receive(const rxFrame_t *frame);
+	bool Receive(const byte frame[], uint8_t len);
+	aggStats_t GetStats(bool reset = false);
+
+private:
+	CC1200 &_radio;
+	uint8_t _address;
+	uint8_t _frameMax;						// Largest length byte: min(PKT_LEN, AGG_FRAME_MAX - 1)
+	aggDeliver_t _deliver;
+	void *_deliverContext;
+	aggTransmit_t _transmit;
+	void *_transmitContext;
+	aggQueue_t _QUEUES[AGG_TARGETS];
+	aggStats_t _stats;
+
+	aggQueue_t *_queue(uint8_t target);
+	bool _full(const aggQueue_t *queue);
+	bool _flush(aggQueue_t *queue, uint32_t *reason);
+	bool _radio_ready(void);
+};
+
+#endif // !_CC120X_AGGREGATE_H
@@ -0,0 +1,583 @@
+/*
+
+Copyright (c) 2018 Md Abdullah AL IMRAN | alimran.mdabdullah@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ 1. Redistributions of source code must retain the above copyright
+	notice, this list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright
+	notice, this list of conditions and the following disclaimer in the
+	documentation and/or other materials provided with the distribution.
+ 3. The name of the author may not be used to endorse or promote products
+	derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "CC120X_Arq.h"
+
+// Sender slot states
+#define ARQ_SLOT_FREE		0
+#define ARQ_SLOT_QUEUED		1		// Not sent yet
+#define ARQ_SLOT_SENT		2		// On air, not acknowledged
+#define ARQ_SLOT_RESEND		3		// Reported missing: send again
+#define ARQ_SLOT_DONE		4		// Acknowledged or given up, waiting for the window to slide
+
+#define ARQ_SLOT(seq)		((seq) & (ARQ_WINDOW - 1))
+
+CC1200Arq::CC1200Arq(CC1200 &radio, uint8_t address) : _radio(radio), _address(address)
+{
+	_window = ARQ_WINDOW;
+	_deliver = NULL;
+	_context = NULL;
+	_rtoInit = ARQ_RTO_MAX_US;
+	_rtoMin = ARQ_RTO_MIN_US;
+	Reset();
+}
+
+// Derive the initial and the smallest retransmit timeout from the air time of a full frame and an ACK, make the
+// radio listen after every TX (RFEND_CFG0.TXOFF_MODE = RX) and enter RX. deliver receives the payloads in order.
+void CC1200Arq::Begin(arqDeliver_t deliver, void *context)
+{
+	_deliver = deliver;
+	_context = context;
+
+	uint32_t ackUs = _radio.AirTimeUs(ARQ_FRAME_HEADER);
+	uint32_t dataUs = _radio.AirTimeUs(ARQ_FRAME_HEADER + ARQ_PAYLOAD_MAX);
+	if (dataUs > 0)
+	{
+		_rtoMin = ackUs + ARQ_RTO_MIN_US;
+		_rtoInit = min(2 * (dataUs + ackUs) + ARQ_RTO_MIN_US, (uint32_t)ARQ_RTO_MAX_US);
+	}
+	for (uint8_t i = 0; i < ARQ_PEERS; i++)
+	{
+		_PEERS[i].STATS.RTO_US = _rtoInit;
+	}
+
+	byte value;
+	_radio.ReadRegister(CC120X_RFEND_CFG0, &value, 1);
+	value |= 0x30; // TXOFF_MODE [5:4] = RX
+	_radio.WriteRegister(CC120X_RFEND_CFG0, &value, 1);
+	_radio.Receive();
+}
+
+// Forget all peers: sequence state, queued frames and statistics
+void CC1200Arq::Reset(void)
+{
+	memset(_PEERS, 0, sizeof(_PEERS));
+	_next = 0;
+	_txStrobed = false;
+}
+
+// Frames in flight per peer, 1 .. ARQ_WINDOW. Takes effect for frames queued afterwards.
+void CC1200Arq::SetWindow(uint8_t frames)
+{
+	_window = max(min(frames, (uint8_t)ARQ_WINDOW), (uint8_t)1);
+}
+
+// Queue 1 .. ARQ_PAYLOAD_MAX bytes for target. The data is copied. FALSE if the window is full (call Service() and
+// try again), the payload does not fit or the peer table is full.
+bool CC1200Arq::Send(uint8_t target, const byte data[], uint8_t len)
+{
+	if (len == 0 || len > ARQ_PAYLOAD_MAX)
+	{
+		return false;
+	}
+	arqPeer_t *peer = _peer(target, true);
+	if (peer == NULL || (uint8_t)(peer->TX_END - peer->TX_BASE) >= _window)
+	{
+		return false;
+	}
+
+	arqSlot_t *slot = &peer->TX[ARQ_SLOT(peer->TX_END)];
+	memcpy(slot->DATA, data, len);
+	slot->LEN = len;
+	slot->TRIES = 0;
+	slot->STATE = ARQ_SLOT_QUEUED;
+	peer->TX_END++;
+	return true;
+}
+
+// Hand over a frame from the received-frame queue. FALSE if it is not an ARQ frame for this node.
+bool CC1200Arq::Receive(const rxFrame_t *frame)
+{
+	if (!frame->CRC_OK || frame->LEN < ARQ_FRAME_HEADER || frame->DATA[0] + 1 != frame->LEN)
+	{
+		return false;
+	}
+	return Receive(frame->DATA, frame->LEN);
+}
+
+// Hand over a frame [Length Target Source Control ...] as read by ReadRxFifo(), with or without the appended status
+// bytes (len = Length + 3 or Length + 1). FALSE if it is not an ARQ frame for this node or failed CRC.
+bool CC1200Arq::Receive(const byte frame[], uint8_t len)
+{
+	if (len < ARQ_FRAME_HEADER || len < frame[0] + 1 || frame[0] + 1 < ARQ_FRAME_HEADER || frame[1] != _address)
+	{
+		return false;
+	}
+	if (len == frame[0] + 3 && !(frame[len - 1] & CC120X_LQI_CRC_OK_BM))
+	{
+		return false;
+	}
+	len = frame[0] + 1;
+
+	arqPeer_t *peer = _peer(frame[2], true);
+	if (peer == NULL)
+	{
+		return false;
+	}
+
+	uint8_t type = frame[3] & ARQ_TYPE_BM;
+	if (type == ARQ_DATA)
+	{
+		if (len == ARQ_FRAME_HEADER || len > ARQ_FRAME_HEADER + ARQ_PAYLOAD_MAX)
+		{
+			return false;
+		}
+		_rx_data(peer, frame, len);
+	}
+	else if (type == ARQ_ACK || type == ARQ_NACK)
+	{
+		_rx_ack(peer, frame[3], frame[4], frame[5]);
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+// Run the timers and send at most one frame: an answer to a poll first, then (unless a poll is open) the next
+// missing or new DATA frame, peers in turn. Returns without SPI traffic beyond MARC_STATE while the radio
+// transmits. Call in the main loop; returns the frames not yet acknowledged, all peers.
+uint16_t CC1200Arq::Service(void)
+{
+	uint32_t now = micros();
+	bool polling = false;
+	uint16_t pending = 0;
+	for (uint8_t i = 0; i < ARQ_PEERS; i++)
+	{
+		arqPeer_t *peer = &_PEERS[i];
+		if (!peer->USED)
+		{
+			continue;
+		}
+		pending += (uint8_t)(peer->TX_END - peer->TX_BASE);
+		if (peer->POLLING)
+		{
+			if (now - peer->POLL_AT >= peer->STATS.RTO_US)
+			{
+				// No answer: back off, the oldest unacknowledged frame polls again
+				peer->POLLING = false;
+				peer->STATS.TIMEOUTS++;
+				peer->STATS.RTO_US = min(peer->STATS.RTO_US * 2, (uint32_t)ARQ_RTO_MAX_US);
+			}
+			else
+			{
+				polling = true;
+			}
+		}
+	}
+
+	byte state = _radio.GetStat(StatType::MARC_STATE, 0x1F);
+	if (state == MARC_STATE_TX_FIFO_ERR || state == MARC_STATE_RX_FIFO_ERR)
+	{
+		_radio.ResolveFifoErr();
+		_txStrobed = false;
+		return pending;
+	}
+	if (state != MARC_STATE_RX && state != MARC_STATE_IDLE)
+	{
+		return pending; // TX, turnaround, settling
+	}
+	if (_txStrobed)
+	{
+		// Frame still in the TX FIFO: the channel was busy (CCA). Try again.
+		byte txBytes;
+		_radio.ReadRegister(CC120X_NUM_TXBYTES, &txBytes, 1);
+		if (txBytes > 0)
+		{
+			_radio.Transmit();
+			return pending;
+		}
+		_txStrobed = false;
+	}
+
+	for (uint8_t i = 0; i < ARQ_PEERS; i++)
+	{
+		arqPeer_t *peer = &_PEERS[(_next + i) % ARQ_PEERS];
+		if (peer->USED && peer->ACK_DUE)
+		{
+			_tx_ack(peer);
+			return pending;
+		}
+	}
+	if (!polling)
+	{
+		for (uint8_t i = 0; i < ARQ_PEERS; i++)
+		{
+			uint8_t index = (_next + i) % ARQ_PEERS;
+			uint8_t seq;
+			if (_PEERS[index].USED && _tx_pick(&_PEERS[index], &seq, true))
+			{
+				_tx_data(&_PEERS[index], seq);
+				_next = (index + 1) % ARQ_PEERS;
+				return pending;
+			}
+		}
+	}
+
+	if (state == MARC_STATE_IDLE)
+	{
+		_radio.Receive();
+	}
+	return pending;
+}
+
+// Frames queued for target and not yet acknowledged
+uint8_t CC1200Arq::Pending(uint8_t target)
+{
+	arqPeer_t *peer = _peer(target, false);
+	return (peer == NULL) ? 0 : (uint8_t)(peer->TX_END - peer->TX_BASE);
+}
+
+// Statistics of a peer (zero if unknown). reset = TRUE clears the counters after reading; the RTT estimate stays.
+arqStats_t CC1200Arq::GetStats(uint8_t address, bool reset)
+{
+	arqStats_t stats;
+	arqPeer_t *peer = _peer(address, false);
+	if (peer == NULL)
+	{
+		memset(&stats, 0, sizeof(stats));
+		return stats;
+	}
+
+	stats = peer->STATS;
+	if (reset)
+	{
+		uint32_t srtt = stats.SRTT_US, rttvar = stats.RTTVAR_US, rto = stats.RTO_US;
+		memset(&peer->STATS, 0, sizeof(peer->STATS));
+		peer->STATS.SRTT_US = srtt;
+		peer->STATS.RTTVAR_US = rttvar;
+		peer->STATS.RTO_US = rto;
+	}
+	return stats;
+}
+
+// Find a peer. create = TRUE takes a free slot for an unknown address; NULL if the table is full.
+arqPeer_t *CC1200Arq::_peer(uint8_t address, bool create)
+{
+	arqPeer_t *free = NULL;
+	for (uint8_t i = 0; i < ARQ_PEERS; i++)
+	{
+		if (_PEERS[i].USED && _PEERS[i].ADDRESS == address)
+		{
+			return &_PEERS[i];
+		}
+		if (!_PEERS[i].USED && free == NULL)
+		{
+			free = &_PEERS[i];
+		}
+	}
+	if (!create || free == NULL)
+	{
+		return NULL;
+	}
+
+	memset(free, 0, sizeof(arqPeer_t));
+	free->USED = true;
+	free->ADDRESS = address;
+	// Start at an arbitrary sequence number: a restarted sender sends SYN with a new Base
+	free->TX_BASE = free->TX_NEXT = free->TX_END = (uint8_t)(micros() ^ address);
+	free->STATS.RTO_US = _rtoInit;
+	return free;
+}
+
+// DATA frame: resynchronize on SYN, skip what the sender gave up, deliver in order or buffer, drop duplicates
+void CC1200Arq::_rx_data(arqPeer_t *peer, const byte frame[], uint8_t len)
+{
+	uint8_t control = frame[3], seq = frame[4], base = frame[5];
+	bool syn = (control & ARQ_SYN) != 0;
+	if (!peer->RX_SYNCED || (syn && base != peer->RX_SYN_BASE))
+	{
+		peer->RX_SYNCED = true;
+		peer->RX_NEXT = base;
+		peer->RX_MASK = 0;
+	}
+	if (syn)
+	{
+		peer->RX_SYN_BASE = base;
+	}
+
+	uint8_t skip = base - peer->RX_NEXT;
+	if (skip > 0 && skip < 0x80)
+	{
+		_rx_advance(peer, skip);
+	}
+
+	uint8_t offset = seq - peer->RX_NEXT;
+	const byte *payload = &frame[ARQ_FRAME_HEADER];
+	uint8_t size = len - ARQ_FRAME_HEADER;
+	if (offset >= ARQ_WINDOW)
+	{
+		if (offset >= 0x80)
+		{
+			peer->STATS.DUPLICATES++; // Behind the window: delivered before, the ACK was lost
+		}
+		else
+		{
+			peer->STATS.OUT_OF_WINDOW++;
+		}
+	}
+	else if (offset == 0)
+	{
+		// In order: straight from the frame, then whatever it unblocks
+		peer->RX_NEXT++;
+		peer->RX_MASK >>= 1;
+		peer->STATS.DELIVERED++;
+		if (_deliver)
+		{
+			_deliver(peer->ADDRESS, payload, size, _context);
+		}
+		_rx_advance(peer, 0);
+	}
+	else if (peer->RX_MASK & (1 << offset))
+	{
+		peer->STATS.DUPLICATES++;
+	}
+	else
+	{
+		memcpy(peer->RX[ARQ_SLOT(seq)], payload, size);
+		peer->RX_LEN[ARQ_SLOT(seq)] = size;
+		peer->RX_MASK |= 1 << offset;
+	}
+
+	if (control & ARQ_POLL)
+	{
+		peer->ACK_DUE = true;
+	}
+}
+
+// ACK/NACK: free what the peer has, and if it answers the open poll, mark the rest of the window for resending
+void CC1200Arq::_rx_ack(arqPeer_t *peer, uint8_t control, uint8_t next, uint8_t bitmap)
+{
+	uint8_t inFlight = peer->TX_NEXT - peer->TX_BASE;
+	uint8_t acked = next - peer->TX_BASE;
+	if (acked > inFlight)
+	{
+		return; // Stale or from an older session
+	}
+
+	for (uint8_t i = 0; i < inFlight; i++)
+	{
+		uint8_t seq = peer->TX_BASE + i;
+		arqSlot_t *slot = &peer->TX[ARQ_SLOT(seq)];
+		uint8_t after = seq - next - 1; // Bitmap bit of seq
+		bool have = (i < acked) || (after < 8 && (bitmap & (1 << after)));
+		if (have && slot->STATE != ARQ_SLOT_DONE)
+		{
+			slot->STATE = ARQ_SLOT_DONE;
+			peer->STATS.ACKED++;
+		}
+		else if (!have && peer->POLLING && slot->STATE == ARQ_SLOT_SENT)
+		{
+			slot->STATE = ARQ_SLOT_RESEND; // Sent before the poll and not received
+		}
+	}
+	if ((control & ARQ_TYPE_BM) == ARQ_NACK)
+	{
+		peer->STATS.NACKS_RECEIVED++;
+	}
+
+	if (peer->POLLING)
+	{
+		peer->POLLING = false;
+		// Any answer ends the backoff; only the answer to a first transmission is an RTT sample (Karn)
+		_rtt_sample(peer, peer->POLL_RETX ? 0 : micros() - peer->POLL_AT);
+	}
+	peer->TX_SYNCED = true;
+	_tx_slide(peer);
+}
+
+// Move the receive window over skip sequence numbers the sender gave up and then over every buffered frame that
+// is next in order, delivering the buffered ones
+void CC1200Arq::_rx_advance(arqPeer_t *peer, uint8_t skip)
+{
+	while (skip > 0 || (peer->RX_MASK & 0x01))
+	{
+		if (peer->RX_MASK & 0x01)
+		{
+			uint8_t index = ARQ_SLOT(peer->RX_NEXT);
+			peer->STATS.DELIVERED++;
+			if (_deliver)
+			{
+				_deliver(peer->ADDRESS, peer->RX[index], peer->RX_LEN[index], _context);
+			}
+		}
+		else
+		{
+			peer->STATS.SKIPPED++;
+		}
+		peer->RX_NEXT++;
+		peer->RX_MASK >>= 1;
+		if (skip > 0)
+		{
+			skip--;
+		}
+	}
+}
+
+// Next DATA frame for peer: the oldest reported missing, else the next new one, else (repoll, no poll open) the
+// oldest unacknowledged to poll again. Frames out of retries are given up on the way. FALSE if none.
+bool CC1200Arq::_tx_pick(arqPeer_t *peer, uint8_t *seq, bool repoll)
+{
+	for (uint8_t pass = 0; pass < 2; pass++)
+	{
+		uint8_t wanted = (pass == 0) ? ARQ_SLOT_RESEND : ARQ_SLOT_SENT;
+		bool gaveUp = false;
+		for (uint8_t s = peer->TX_BASE; s != peer->TX_NEXT; s++)
+		{
+			arqSlot_t *slot = &peer->TX[ARQ_SLOT(s)];
+			if (slot->STATE != wanted)
+			{
+				continue;
+			}
+			if (slot->TRIES < ARQ_MAX_RETRIES)
+			{
+				*seq = s;
+				return true;
+			}
+			slot->STATE = ARQ_SLOT_DONE;
+			peer->STATS.FAILED++;
+			gaveUp = true;
+		}
+		if (gaveUp)
+		{
+			_tx_slide(peer);
+		}
+
+		if (peer->TX_NEXT != peer->TX_END)
+		{
+			*seq = peer->TX_NEXT;
+			return true;
+		}
+		if (!repoll || peer->POLLING)
+		{
+			break;
+		}
+	}
+	return false;
+}
+
+// Release acknowledged/given-up frames at the bottom of the window
+void CC1200Arq::_tx_slide(arqPeer_t *peer)
+{
+	while (peer->TX_BASE != peer->TX_NEXT && peer->TX[ARQ_SLOT(peer->TX_BASE)].STATE == ARQ_SLOT_DONE)
+	{
+		peer->TX[ARQ_SLOT(peer->TX_BASE)].STATE = ARQ_SLOT_FREE;
+		peer->TX_BASE++;
+	}
+}
+
+// Write DATA frame seq to the TX FIFO and strobe TX. POLL is set when nothing else is ready to go.
+void CC1200Arq::_tx_data(arqPeer_t *peer, uint8_t seq)
+{
+	arqSlot_t *slot = &peer->TX[ARQ_SLOT(seq)];
+	uint32_t now = micros();
+	slot->STATE = ARQ_SLOT_SENT;
+	slot->TRIES++;
+	slot->SENT_AT = now;
+	if (seq == peer->TX_NEXT)
+	{
+		peer->TX_NEXT++;
+	}
+	peer->STATS.SENT++;
+	if (slot->TRIES > 1)
+	{
+		peer->STATS.RETRANSMITS++;
+	}
+
+	uint8_t more;
+	bool poll = !_tx_pick(peer, &more, false);
+	byte header[3];
+	header[0] = ARQ_DATA | (poll ? ARQ_POLL : 0) | (peer->TX_SYNCED ? 0 : ARQ_SYN);
+	header[1] = seq;
+	header[2] = peer->TX_BASE;
+	txSegment_t segments[2] = { { header, 3 }, { slot->DATA, slot->LEN } };
+	_radio.WriteTxFifo(peer->ADDRESS, _address, segments, 2);
+	_radio.Transmit();
+	_txStrobed = true;
+
+	if (poll)
+	{
+		peer->POLLING = true;
+		peer->POLL_RETX = (slot->TRIES > 1);
+		peer->POLL_AT = now;
+	}
+}
+
+// Answer a poll: next sequence number expected and the frames buffered after it
+void CC1200Arq::_tx_ack(arqPeer_t *peer)
+{
+	byte header[3];
+	bool gap = (peer->RX_MASK != 0);
+	header[0] = gap ? ARQ_NACK : ARQ_ACK;
+	header[1] = peer->RX_NEXT;
+	header[2] = peer->RX_MASK >> 1;
+	txSegment_t segment = { header, 3 };
+	_radio.WriteTxFifo(peer->ADDRESS, _address, &segment, 1);
+	_radio.Transmit();
+	_txStrobed = true;
+
+	peer->ACK_DUE = false;
+	if (gap)
+	{
+		peer->STATS.NACKS_SENT++;
+	}
+	else
+	{
+		peer->STATS.ACKS_SENT++;
+	}
+}
+
+// Round trip estimate and retransmit timeout as in RFC 6298. rttUs = 0: no sample, the timeout is recomputed from
+// the estimate (the initial timeout, derived from the air time, before the first sample).
+void CC1200Arq::_rtt_sample(arqPeer_t *peer, uint32_t rttUs)
+{
+	arqStats_t *stats = &peer->STATS;
+	if (rttUs == 0)
+	{
+		if (stats->SRTT_US == 0)
+		{
+			stats->RTO_US = _rtoInit;
+			return;
+		}
+	}
+	else if (stats->SRTT_US == 0)
+	{
+		stats->SRTT_US = rttUs;
+		stats->RTTVAR_US = rttUs / 2;
+	}
+	else
+	{
+		uint32_t delta = (stats->SRTT_US > rttUs) ? stats->SRTT_US - rttUs : rttUs - stats->SRTT_US;
+		stats->RTTVAR_US = (3 * stats->RTTVAR_US + delta) / 4;
+		stats->SRTT_US = (7 * stats->SRTT_US + rttUs) / 8;
+	}
+	stats->RTO_US = min(max(stats->SRTT_US + max(4 * stats->RTTVAR_US, (uint32_t)ARQ_RTO_MIN_US), _rtoMin), (uint32_t)ARQ_RTO_MAX_US);
+}
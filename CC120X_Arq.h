@@ -0,0 +1,148 @@
+#ifndef _CC120X_ARQ_H
+#define _CC120X_ARQ_H
+
+/* =====================================================================================================================
+												RELIABLE DELIVERY (ARQ)
+  ===================================================================================================================== */
+// Selective-repeat ARQ on top of WriteTxFifo()/ReadRxFifo(). Every peer has its own 8-bit sequence numbers and a
+// sliding window of up to ARQ_WINDOW frames. The sender transmits the window back to back and sets POLL on the
+// last frame; the receiver answers with one ACK (or NACK when frames are missing) carrying the next sequence
+// number expected and a bitmap of the frames received after it, so only the missing frames are sent again.
+// Frames are delivered in order, duplicates are dropped. The retransmit timeout starts from the air time of a
+// frame and an ACK at the configured symbol rate and then follows the measured round trip (RFC 6298, Karn).
+// The object belongs to the caller; received frames are handed to it, e.g.
+//
+//   CC1200Arq arq(cc1200, THIS_NODE);
+//   arq.Begin(onMessage);
+//   ...
+//   arq.Send(TARG_NODE, data, len);            // FALSE while the window is full
+//   rxFrame_t *frame = cc1200.PeekFrame();
+//   if (frame) { arq.Receive(frame); cc1200.PopFrame(); }
+//   arq.Service();                             // transmit, retransmit, acknowledge
+//
+// Frames: [Length Target Source Control Sequence Base --Payload--]		DATA, Base = oldest unacknowledged
+//         [Length Target Source Control Next Bitmap]					ACK/NACK, bit i = Next + 1 + i received
+//
+// The radio is half-duplex: after a poll nothing but ACKs is sent until the answer or the timeout. A CCA mode
+// (ConfigureCca) keeps Service() from transmitting over a frame being received.
+
+#include "CC1200.h"
+
+#ifndef ARQ_PEERS
+#define ARQ_PEERS			2			// Peers with sequence state (sender and receiver side)
+#endif
+#ifndef ARQ_WINDOW
+#define ARQ_WINDOW			8			// Largest window in frames (1, 2, 4 or 8: one bitmap byte)
+#endif
+#ifndef ARQ_PAYLOAD_MAX
+#define ARQ_PAYLOAD_MAX		48			// Payload bytes per frame. Frame = payload + ARQ_FRAME_HEADER, <= CC1200_RX_FRAME_MAX.
+#endif
+#define ARQ_FRAME_HEADER	6			// [Length Target Source Control Sequence Base/Bitmap]
+#define ARQ_MAX_RETRIES		8			// Transmissions of a frame before it is given up
+#define ARQ_RTO_MIN_US		2000		// Added to the RTO: MCU latency between packet end and Service()
+#define ARQ_RTO_MAX_US		2000000UL	// Retransmit timeout ceiling (exponential backoff)
+
+// Control byte
+#define ARQ_DATA			0x00
+#define ARQ_ACK				0x01
+#define ARQ_NACK			0x02		// ACK with frames missing before the highest received
+#define ARQ_TYPE_BM			0x03
+#define ARQ_POLL			0x40		// DATA: acknowledge now
+#define ARQ_SYN				0x80		// DATA: sender has no ACK yet. A new Base resynchronizes the receiver.
+
+// In-order delivery of a received payload
+typedef void (*arqDeliver_t)(uint8_t source, const byte data[], uint8_t len, void *context);
+
+// ARQ accounting per peer
+typedef struct ArqStats
+{
+	uint32_t SENT;							// DATA frames transmitted, retransmissions included
+	uint32_t RETRANSMITS;					// DATA frames transmitted again
+	uint32_t ACKED;							// Frames confirmed by the peer
+	uint32_t FAILED;						// Frames given up after ARQ_MAX_RETRIES
+	uint32_t TIMEOUTS;						// Polls not answered within RTO
+	uint32_t NACKS_RECEIVED;				// Answers reporting missing frames
+	uint32_t DELIVERED;						// Payloads passed on in order
+	uint32_t DUPLICATES;					// Frames received again (dropped)
+	uint32_t OUT_OF_WINDOW;					// Frames beyond the receive window (dropped)
+	uint32_t SKIPPED;						// Sequence numbers given up by the sender (never delivered)
+	uint32_t ACKS_SENT, NACKS_SENT;
+	uint32_t SRTT_US, RTTVAR_US, RTO_US;	// Round trip estimate (poll to answer) and retransmit timeout
+} arqStats_t;
+
+// Sender copy of one frame in the window
+typedef struct ArqSlot
+{
+	uint8_t STATE;							// ARQ_SLOT_*
+	uint8_t LEN;
+	uint8_t TRIES;							// Transmissions so far
+	uint32_t SENT_AT;						// micros() of the last transmission
+	byte DATA[ARQ_PAYLOAD_MAX];
+} arqSlot_t;
+
+// Sequence state of one peer
+typedef struct ArqPeer
+{
+	bool USED;
+	uint8_t ADDRESS;
+
+	// Sender: TX_BASE <= TX_NEXT <= TX_END
+	uint8_t TX_BASE;						// Oldest unacknowledged
+	uint8_t TX_NEXT;						// Next sent for the first time
+	uint8_t TX_END;							// Next assigned by Send()
+	bool TX_SYNCED;							// ACK received: SYN off
+	bool POLLING;							// Waiting for the answer to a poll
+	bool POLL_RETX;							// The poll was a retransmission: no RTT sample (Karn)
+	uint32_t POLL_AT;
+	arqSlot_t TX[ARQ_WINDOW];
+
+	// Receiver
+	bool RX_SYNCED;
+	uint8_t RX_NEXT;						// Next expected in order
+	uint8_t RX_SYN_BASE;					// Base of the last SYN frame
+	uint8_t RX_MASK;						// Bit i: RX_NEXT + i buffered
+	bool ACK_DUE;							// Poll received, answer not sent yet
+	uint8_t RX_LEN[ARQ_WINDOW];
+	byte RX[ARQ_WINDOW][ARQ_PAYLOAD_MAX];
+
+	arqStats_t STATS;
+} arqPeer_t;
+
+class CC1200Arq
+{
+public:
+	CC1200Arq(CC1200 &radio, uint8_t address);
+	void Begin(arqDeliver_t deliver, void *context = NULL);
+	void Reset(void);
+	void SetWindow(uint8_t frames);
+
+	bool Send(uint8_t target, const byte data[], uint8_t len);
+	bool Receive(const rxFrame_t *frame);
+	bool Receive(const byte frame[], uint8_t len);
+	uint16_t Service(void);
+	uint8_t Pending(uint8_t target);
+	arqStats_t GetStats(uint8_t address, bool reset = false);
+
+private:
+	CC1200 &_radio;
+	uint8_t _address;
+	uint8_t _window;
+	uint8_t _next;							// Peer served first by the next Service()
+	bool _txStrobed;						// STX given: check the TX FIFO drained (CCA may have held it)
+	uint32_t _rtoInit, _rtoMin;
+	arqDeliver_t _deliver;
+	void *_context;
+	arqPeer_t _PEERS[ARQ_PEERS];
+
+	arqPeer_t *_peer(uint8_t address, bool create);
+	void _rx_data(arqPeer_t *peer, const byte frame[], uint8_t len);
+	void _rx_ack(arqPeer_t *peer, uint8_t control, uint8_t next, uint8_t bitmap);
+	void _rx_advance(arqPeer_t *peer, uint8_t skip);
+	bool _tx_pick(arqPeer_t *peer, uint8_t *seq, bool repoll);
+	void _tx_slide(arqPeer_t *peer);
+	void _tx_data(arqPeer_t *peer, uint8_t seq);
+	void _tx_ack(arqPeer_t *peer);
+	void _rtt_sample(arqPeer_t *peer, uint32_t rttUs);
+};
+
+#endif // !_CC120X_ARQ_H
@@ -0,0 +1,177 @@
+#ifndef _CC120X_HOST_H
+#define _CC120X_HOST_H
+
+/* =====================================================================================================================
+												HOST (NON-ARDUINO) SHIM
+  ===================================================================================================================== */
+// Minimal subset of the Arduino core used by the library so that CC1200.cpp builds unmodified on a
+// desktop host (Linux/macOS) together with HostSpiTransport. Time is virtual: delay(), delayMicroseconds()
+// and SPI bus activity advance a simulated microsecond clock, which keeps host runs deterministic.
+// Interrupts attached with attachInterrupt() run synchronously when a device model drives the pin.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH			0x1
+#define LOW				0x0
+#define INPUT			0x0
+#define OUTPUT			0x1
+#define INPUT_PULLUP	0x2
+
+// Default SPI pins (Arduino Mega numbering)
+#define SS				53
+#define MOSI			51
+#define MISO			50
+#define SCK				52
+
+template <class T, class U> inline T min(T a, U b) { return (b < a) ? b : a; }
+template <class T, class U> inline T max(T a, U b) { return (a < b) ? b : a; }
+
+#define lowByte(w) ((uint8_t) ((w) & 0xFF))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+
+#define CHANGE			0x1
+#define FALLING			0x2
+#define RISING			0x3
+
+#define digitalPinToInterrupt(p) (p)
+
+typedef void (*hostCallback_t)(void);
+
+// Virtual pin levels. The device model may drive input pins (e.g. MISO, GPIOx) from here.
+inline uint8_t *host_pins(void)
+{
+	static uint8_t pins[256];
+	return pins;
+}
+
+// Pin change interrupts: handler and mode per pin
+inline hostCallback_t *host_isr(void)
+{
+	static hostCallback_t isr[256];
+	return isr;
+}
+
+inline uint8_t *host_isr_mode(void)
+{
+	static uint8_t mode[256];
+	return mode;
+}
+
+// Virtual microsecond clock
+inline uint32_t &host_clock_us(void)
+{
+	static uint32_t us = 0;
+	return us;
+}
+
+// Called whenever the clock advances. A device model uses it to run its own events.
+inline hostCallback_t &host_tick_hook(void)
+{
+	static hostCallback_t hook = 0;
+	return hook;
+}
+
+inline void host_advance(uint32_t us)
+{
+	host_clock_us() += us;
+	if (host_tick_hook()) host_tick_hook()();
+}
+
+inline void attachInterrupt(uint8_t interrupt, hostCallback_t isr, int mode)
+{
+	host_isr()[interrupt] = isr;
+	host_isr_mode()[interrupt] = mode;
+}
+
+inline void detachInterrupt(uint8_t interrupt)
+{
+	host_isr()[interrupt] = 0;
+}
+
+// ISRs do not nest: an edge raised while a handler runs is served right after it, as on the MCU
+inline void host_run_isr(uint8_t pin)
+{
+	static bool active = false;
+	static uint8_t pending[256];
+
+	if (active)
+	{
+		pending[pin] = 1;
+		return;
+	}
+
+	active = true;
+	host_isr()[pin]();
+	for (bool again = true; again; )
+	{
+		again = false;
+		for (uint16_t p = 0; p < 256; p++)
+		{
+			if (pending[p])
+			{
+				pending[p] = 0;
+				again = true;
+				if (host_isr()[p]) host_isr()[p]();
+			}
+		}
+	}
+	active = false;
+}
+
+inline void noInterrupts(void) {}
+inline void interrupts(void) {}
+
+inline void pinMode(uint8_t pin, uint8_t mode)
+{
+	if (mode == INPUT_PULLUP) host_pins()[pin] = HIGH;
+}
+
+// Writing a pin with an attached interrupt fires the handler on a matching edge
+inline void digitalWrite(uint8_t pin, uint8_t val)
+{
+	uint8_t old = host_pins()[pin];
+	uint8_t now = val ? HIGH : LOW;
+	host_pins()[pin] = now;
+
+	hostCallback_t isr = host_isr()[pin];
+	if (isr && old != now)
+	{
+		uint8_t mode = host_isr_mode()[pin];
+		if (mode == CHANGE || (mode == RISING && now) || (mode == FALLING && !now))
+		{
+			host_run_isr(pin);
+		}
+	}
+}
+
+inline int digitalRead(uint8_t pin)
+{
+	return host_pins()[pin];
+}
+
+inline void delayMicroseconds(unsigned int us)
+{
+	host_advance(us);
+}
+
+inline void delay(unsigned long ms)
+{
+	host_advance(ms * 1000UL);
+}
+
+inline unsigned long micros(void)
+{
+	return host_clock_us();
+}
+
+inline unsigned long millis(void)
+{
+	return host_clock_us() / 1000UL;
+}
+
+#endif // !_CC120X_HOST_H
@@ -13,6 +13,35 @@ typedef struct RegValuePair
 	byte VALUE;
 } registerSetting_t;
 
+// SPI Transaction Types
+#define SPI_TRANS_READ		0x00	// Read LEN bytes (burst if LEN > 1)
+#define SPI_TRANS_WRITE		0x01	// Write LEN bytes (burst if LEN > 1)
+#define SPI_TRANS_STROBE	0x02	// Command strobe. ADDRESS holds the command, LEN is ignored.
+
+// SPI Transaction States
+#define SPI_TRANS_IDLE		0x00	// Not submitted
+#define SPI_TRANS_QUEUED	0x01	// Waiting for the bus
+#define SPI_TRANS_ACTIVE	0x02	// Being shifted
+#define SPI_TRANS_DONE		0x03	// Completed. BUFFER holds read data.
+
+// SPI Transaction Descriptor - owned by the caller and must stay valid until DONE
+typedef struct SpiTransaction
+{
+	uint8_t TYPE;					// SPI_TRANS_READ / WRITE / STROBE
+	uint16_t ADDRESS;				// Normal/extended register, FIFO (0x3F), DMA (0x3E) or strobe command
+	uint8_t *BUFFER;				// Data to write / space for data read
+	uint8_t LEN;					// Data bytes
+	void (*CALLBACK)(struct SpiTransaction *transaction);	// Completion (interrupt context). May be NULL.
+	void *CONTEXT;					// Caller data for CALLBACK
+	volatile uint8_t STATE;			// SPI_TRANS_IDLE / QUEUED / ACTIVE / DONE
+	uint8_t STATUS;					// Chip status byte returned with the header
+
+	// Engine internals
+	struct SpiTransaction *_next;
+	uint8_t _ss, _miso, _hdr;
+	uint16_t _pos;					// Header + LEN reaches 256 and more
+} spiTransaction_t;
+
 /* =====================================================================================================================
 													STATUS/ERROR CODES
   ===================================================================================================================== */
@@ -172,5 +201,61 @@ typedef struct RegValuePair
 #define MARC_STATE_RESERVED      24 // 24-31 RESERVED. Blanks are SETTLING.
 /******************************************************************************/
 
+
+
+
+
+/******************************************************************************
+* GPIO OUTPUT SIGNALS - GPIO Output Signals table, IOCFGx.GPIOx_CFG [5:0].
+*                       Set IOCFGx.GPIOx_INV [6] to invert.
+*/
+#define GPIO_RXFIFO_THR           0   // Asserted when RX FIFO is filled above FIFO_CFG.FIFO_THR
+#define GPIO_RXFIFO_THR_PKT       1   // As above, or at the end of packet
+#define GPIO_TXFIFO_THR           2   // Asserted when TX FIFO is filled above (127 - FIFO_CFG.FIFO_THR)
+#define GPIO_TXFIFO_THR_PKT       3   // As above, de-asserted when the TX FIFO drains below threshold
+#define GPIO_RXFIFO_OVERFLOW      4   // Asserted when RX FIFO has overflowed
+#define GPIO_TXFIFO_UNDERFLOW     5   // Asserted when TX FIFO has underflowed
+#define GPIO_PKT_SYNC_RXTX        6   // Asserted on sync word. De-asserted at end of packet.
+#define GPIO_PKT_CRC_OK           7   // Asserted at end of packet with CRC OK. De-asserted on RX entry.
+#define GPIO_SERIAL_CLK           8   // Synchronous serial clock
+#define GPIO_SERIAL_RX            9   // Synchronous serial RX data
+#define GPIO_PQT_REACHED          11  // Preamble quality reached
+#define GPIO_PQT_VALID            12  // Preamble quality valid
+#define GPIO_RSSI_VALID           13  // RSSI calculation is valid
+#define GPIO_CARRIER_SENSE_VALID  16  // Carrier sense is valid
+#define GPIO_CARRIER_SENSE        17  // Carrier sense (RSSI above AGC_CS_THR)
+#define GPIO_MCU_WAKEUP           42  // MARC_STATUS1 event. Read MARC_STATUS1 for the cause.
+#define GPIO_HIGHZ                48  // High impedance (tri-state)
+#define GPIO_CHIP_RDYn            50  // Chip ready (active low)
+#define GPIO_HW0                  51  // Logic 0
+#define GPIO_INV                  0x40 // Invert output
+/******************************************************************************/
+
+
+
+
+
+/******************************************************************************
+* MODEM STATUS / FIFO CONFIGURATION BITS - MODEM_STATUS1, MODEM_STATUS0 and FIFO_CFG
+*                                          Register Descriptions
+*/
+#define MODEM_STATUS1_SYNC_FOUND        0x80
+#define MODEM_STATUS1_RXFIFO_FULL       0x40
+#define MODEM_STATUS1_RXFIFO_THR        0x20
+#define MODEM_STATUS1_RXFIFO_EMPTY      0x10
+#define MODEM_STATUS1_RXFIFO_OVERFLOW   0x08
+#define MODEM_STATUS1_RXFIFO_UNDERFLOW  0x04
+#define MODEM_STATUS1_PQT_REACHED       0x02
+#define MODEM_STATUS1_PQT_VALID         0x01
+
+#define MODEM_STATUS0_SYNC_SENT         0x04
+#define MODEM_STATUS0_TXFIFO_FULL       0x02
+#define MODEM_STATUS0_TXFIFO_THR        0x01
+
+#define FIFO_CFG_CRC_AUTOFLUSH          0x80  // Flush RX FIFO on CRC error
+#define FIFO_CFG_FIFO_THR               0x7F  // Threshold: RX = FIFO_THR + 1 bytes, TX = 127 - FIFO_THR bytes
+#define FIFO_SIZE_BYTES                 128   // TX and RX FIFO depth
+/******************************************************************************/
+
 #endif // !_CC120X_MISC_H
 
@@ -0,0 +1,1162 @@
+/*
+
+Copyright (c) 2018 Md Abdullah AL IMRAN | alimran.mdabdullah@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ 1. Redistributions of source code must retain the above copyright
+	notice, this list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright
+	notice, this list of conditions and the following disclaimer in the
+	documentation and/or other materials provided with the distribution.
+ 3. The name of the author may not be used to endorse or promote products
+	derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "CC120X_Sim.h"
+
+#if !defined(ARDUINO)
+
+#define SIM_NEVER		0xFFFFFFFFUL
+#define SIM_FXOSC		40000000ULL		// 40 MHz crystal (CC1200EMK)
+
+// Normal register space reset values [0x00-0x2E]
+static const uint8_t SIM_REG_DEFAULTS[0x2F] = {
+	0x06, 0x07, 0x30, 0x3C, 0x93, 0x0B, 0x51, 0xDE,		// IOCFG3 .. SYNC0
+	0xAA, 0x03, 0x06, 0x03, 0x4C, 0x14, 0xDA, 0xC4,		// SYNC_CFG1 .. IQIC
+	0x94, 0x46, 0x0D, 0x43, 0xA9, 0x2A, 0x36, 0x00,		// CHAN_BW .. AGC_CS_THR
+	0x00, 0xB1, 0x20, 0x12, 0x80, 0x80, 0x00, 0x0B,		// AGC_GAIN_ADJUST .. SETTLING_CFG
+	0x03, 0x08, 0x21, 0x00, 0x00, 0x00, 0x04, 0x03,		// FS_CFG .. PKT_CFG1
+	0x00, 0x0F, 0x00, 0x7F, 0x56, 0x0F, 0x03			// PKT_CFG0 .. PKT_LEN
+};
+
+// Preamble bits per PREAMBLE_CFG1.NUM_PREAMBLE and sync bits per SYNC_CFG1.SYNC_MODE
+static const uint8_t SIM_PREAMBLE_BITS[16] = { 0, 4, 8, 12, 16, 24, 32, 40, 48, 56, 64, 96, 192, 240, 0, 0 };
+static const uint8_t SIM_SYNC_BITS[8] = { 0, 11, 16, 18, 24, 32, 16, 16 };
+
+// AES S-box (FIPS-197)
+static const uint8_t SIM_AES_SBOX[256] = {
+	0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F, 0xC5, 0x30, 0x01, 0x67, 0x2B, 0xFE, 0xD7, 0xAB, 0x76,
+	0xCA, 0x82, 0xC9, 0x7D, 0xFA, 0x59, 0x47, 0xF0, 0xAD, 0xD4, 0xA2, 0xAF, 0x9C, 0xA4, 0x72, 0xC0,
+	0xB7, 0xFD, 0x93, 0x26, 0x36, 0x3F, 0xF7, 0xCC, 0x34, 0xA5, 0xE5, 0xF1, 0x71, 0xD8, 0x31, 0x15,
+	0x04, 0xC7, 0x23, 0xC3, 0x18, 0x96, 0x05, 0x9A, 0x07, 0x12, 0x80, 0xE2, 0xEB, 0x27, 0xB2, 0x75,
+	0x09, 0x83, 0x2C, 0x1A, 0x1B, 0x6E, 0x5A, 0xA0, 0x52, 0x3B, 0xD6, 0xB3, 0x29, 0xE3, 0x2F, 0x84,
+	0x53, 0xD1, 0x00, 0xED, 0x20, 0xFC, 0xB1, 0x5B, 0x6A, 0xCB, 0xBE, 0x39, 0x4A, 0x4C, 0x58, 0xCF,
+	0xD0, 0xEF, 0xAA, 0xFB, 0x43, 0x4D, 0x33, 0x85, 0x45, 0xF9, 0x02, 0x7F, 0x50, 0x3C, 0x9F, 0xA8,
+	0x51, 0xA3, 0x40, 0x8F, 0x92, 0x9D, 0x38, 0xF5, 0xBC, 0xB6, 0xDA, 0x21, 0x10, 0xFF, 0xF3, 0xD2,
+	0xCD, 0x0C, 0x13, 0xEC, 0x5F, 0x97, 0x44, 0x17, 0xC4, 0xA7, 0x7E, 0x3D, 0x64, 0x5D, 0x19, 0x73,
+	0x60, 0x81, 0x4F, 0xDC, 0x22, 0x2A, 0x90, 0x88, 0x46, 0xEE, 0xB8, 0x14, 0xDE, 0x5E, 0x0B, 0xDB,
+	0xE0, 0x32, 0x3A, 0x0A, 0x49, 0x06, 0x24, 0x5C, 0xC2, 0xD3, 0xAC, 0x62, 0x91, 0x95, 0xE4, 0x79,
+	0xE7, 0xC8, 0x37, 0x6D, 0x8D, 0xD5, 0x4E, 0xA9, 0x6C, 0x56, 0xF4, 0xEA, 0x65, 0x7A, 0xAE, 0x08,
+	0xBA, 0x78, 0x25, 0x2E, 0x1C, 0xA6, 0xB4, 0xC6, 0xE8, 0xDD, 0x74, 0x1F, 0x4B, 0xBD, 0x8B, 0x8A,
+	0x70, 0x3E, 0xB5, 0x66, 0x48, 0x03, 0xF6, 0x0E, 0x61, 0x35, 0x57, 0xB9, 0x86, 0xC1, 0x1D, 0x9E,
+	0xE1, 0xF8, 0x98, 0x11, 0x69, 0xD9, 0x8E, 0x94, 0x9B, 0x1E, 0x87, 0xE9, 0xCE, 0x55, 0x28, 0xDF,
+	0x8C, 0xA1, 0x89, 0x0D, 0xBF, 0xE6, 0x42, 0x68, 0x41, 0x99, 0x2D, 0x0F, 0xB0, 0x54, 0xBB, 0x16
+};
+
+// AES-128 encryption of one block in place, round keys expanded on the fly
+static void sim_aes_encrypt(const uint8_t key[16], uint8_t block[16])
+{
+	uint8_t k[16], t[16], rcon = 0x01;
+	memcpy(k, key, 16);
+	for (uint8_t i = 0; i < 16; i++) block[i] ^= k[i];
+
+	for (uint8_t round = 1; round <= 10; round++)
+	{
+		// SubBytes + ShiftRows
+		for (uint8_t c = 0; c < 4; c++)
+		{
+			for (uint8_t r = 0; r < 4; r++) t[4 * c + r] = SIM_AES_SBOX[block[4 * ((c + r) & 3) + r]];
+		}
+		// MixColumns (not in the last round)
+		for (uint8_t c = 0; c < 4; c++)
+		{
+			uint8_t *col = &t[4 * c];
+			uint8_t all = col[0] ^ col[1] ^ col[2] ^ col[3], first = col[0];
+			for (uint8_t r = 0; r < 4; r++)
+			{
+				uint8_t x = col[r] ^ (r < 3 ? col[r + 1] : first);
+				x = (uint8_t)((x << 1) ^ ((x & 0x80) ? 0x1B : 0x00));
+				block[4 * c + r] = (round < 10) ? (col[r] ^ all ^ x) : col[r];
+			}
+		}
+		// Next round key
+		k[0] ^= SIM_AES_SBOX[k[13]] ^ rcon;
+		k[1] ^= SIM_AES_SBOX[k[14]];
+		k[2] ^= SIM_AES_SBOX[k[15]];
+		k[3] ^= SIM_AES_SBOX[k[12]];
+		for (uint8_t i = 4; i < 16; i++) k[i] ^= k[i - 4];
+		rcon = (uint8_t)((rcon << 1) ^ ((rcon & 0x80) ? 0x1B : 0x00));
+		for (uint8_t i = 0; i < 16; i++) block[i] ^= k[i];
+	}
+}
+
+CC1200Sim *CC1200Sim::_ACTIVE[4] = { NULL, NULL, NULL, NULL };
+
+CC1200Sim::CC1200Sim(void)
+{
+	memset(&Stats, 0, sizeof(Stats));
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		_GPIO_PIN[i] = -1;
+		_gpioLevel[i] = 0;
+	}
+	_PEER = NULL;
+	_lossPercent = 0;
+	_lossSeed = 1;
+	_inTick = false;
+	_channelRssi = -110;
+	_now = host_clock_us();
+	_worBase = _now;
+	PowerOn();
+}
+
+// Put this chip behind HostSpiTransport on chip-select pin ssPin and drive it from the host clock
+void CC1200Sim::Attach(uint8_t ssPin)
+{
+	HostSpiTransport::Attach(this, ssPin);
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		if (_ACTIVE[i] == this) break;
+		if (_ACTIVE[i] == NULL)
+		{
+			_ACTIVE[i] = this;
+			break;
+		}
+	}
+	host_tick_hook() = _tickAll;
+}
+
+// Power-on reset. CHIP_RDYn stays HIGH for RESET_US.
+void CC1200Sim::PowerOn(void)
+{
+	_reset();
+	_readyAt = _now + RESET_US;
+}
+
+// Drive host pin from GPIOx output. -1 disconnects.
+void CC1200Sim::ConnectGpio(uint8_t gpio, int16_t hostPin)
+{
+	if (gpio < 4)
+	{
+		_GPIO_PIN[gpio] = hostPin;
+		_gpioLevel[gpio] = 0xFF; // Force first update
+		_updateGpio();
+	}
+}
+
+// Frames sent on air by this chip are received by peer
+void CC1200Sim::Link(CC1200Sim *peer)
+{
+	_PEER = peer;
+}
+
+// RSSI on the channel when no frame is on air
+void CC1200Sim::SetChannelRssi(int8_t dBm)
+{
+	_channelRssi = dBm;
+	_updateGpio();
+}
+
+// Lose percent of the frames sent to the linked peer. The loss pattern repeats for the same seed.
+void CC1200Sim::SetLoss(uint8_t percent, uint32_t seed)
+{
+	_lossPercent = min(percent, (uint8_t)100);
+	_lossSeed = seed;
+}
+
+// Schedule a frame on air. It is received only if the chip is in RX when the sync word arrives.
+bool CC1200Sim::InjectPacket(const uint8_t *frame, uint16_t len, int8_t rssi, uint8_t lqi, bool crcOk)
+{
+	Tick();
+	if (_airRxActive || len == 0 || len > sizeof(_AIRRX))
+	{
+		return false;
+	}
+
+	memcpy(_AIRRX, frame, len);
+	_airRxLen = len;
+	_airRxPos = 0;
+	_airRxRssi = rssi;
+	_airRxLqi = lqi;
+	_airRxCrcOk = crcOk;
+	_airRxSynced = false;
+	_airRxActive = true;
+	_airRxNextAt = _now + (uint32_t)_headBytes() * _byteUs();
+	return true;
+}
+
+// Register value without side effects (MARC_STATUS1 is not cleared, RNDGEN does not advance)
+uint8_t CC1200Sim::Peek(uint16_t address)
+{
+	if (address == CC120X_MARC_STATUS1) return _marcStatus1;
+	if (address == CC120X_RNDGEN) return _EXT[lowByte(CC120X_RNDGEN)];
+	return _readReg(address);
+}
+
+// Set register value directly, bypassing the SPI bus
+void CC1200Sim::Poke(uint16_t address, uint8_t value)
+{
+	if ((address >> 8) == 0x2F) _EXT[lowByte(address)] = value;
+	else if (address < 0x2F) _REGS[address] = value;
+	_updateGpio();
+}
+
+// Last frame sent on air. Returns its length.
+uint16_t CC1200Sim::LastTxFrame(uint8_t *buffer)
+{
+	memcpy(buffer, _LASTTX, _lastTxLen);
+	return _lastTxLen;
+}
+
+// Frequency synthesizer calibration registers match the programmed frequency
+bool CC1200Sim::FsCalibrated(void)
+{
+	uint32_t freq = _freq();
+	return _EXT[lowByte(CC120X_FS_VCO2)] == (uint8_t)(((freq >> 12) ^ 0x5A) & 0x7F)
+		&& _EXT[lowByte(CC120X_FS_VCO4)] == (uint8_t)((freq >> 7) & 0x1F)
+		&& _EXT[lowByte(CC120X_FS_CHP)] == (uint8_t)(0x20 | ((freq >> 14) & 0x1F));
+}
+
+// Symbol rate from SYMBOL_RATE2..0: Rsym = (2^20 + M) * 2^E / 2^39 * fxosc (E > 0) or M / 2^38 * fxosc (E = 0)
+uint32_t CC1200Sim::SymbolRate(void)
+{
+	uint8_t e = _REGS[CC120X_SYMBOL_RATE2] >> 4;
+	uint32_t m = ((uint32_t)(_REGS[CC120X_SYMBOL_RATE2] & 0x0F) << 16) | ((uint16_t)_REGS[CC120X_SYMBOL_RATE1] << 8) | _REGS[CC120X_SYMBOL_RATE0];
+
+	if (e == 0)
+	{
+		return (uint32_t)((m * SIM_FXOSC) >> 38);
+	}
+	return (uint32_t)((((1ULL << 20) + m) << e) * SIM_FXOSC >> 39);
+}
+
+// Process pending events up to the host clock
+void CC1200Sim::Tick(void)
+{
+	if (_inTick) return;
+	_inTick = true;
+	_runEvents(host_clock_us());
+	_inTick = false;
+}
+
+/* SPI Bus Interface */
+// CS asserted. MISO stays HIGH (driver keeps waiting) until the crystal is stable.
+void CC1200Sim::Select(void)
+{
+	Tick();
+	_wake();
+	if (!_ready())
+	{
+		host_advance(_readyAt - _now);
+		Tick();
+	}
+	_phase = SPI_HEADER;
+}
+
+// CHIP_RDYn sampled by a short CS pulse (the pulse wakes the chip)
+bool CC1200Sim::Ready(void)
+{
+	Tick();
+	_wake();
+	return _ready();
+}
+
+// CS LOW in SLEEP/XOFF starts the crystal
+void CC1200Sim::_wake(void)
+{
+	if (_state == MARC_STATE_SLEEP || _state == MARC_STATE_XOFF)
+	{
+		if (_state == MARC_STATE_SLEEP)
+		{
+			_txFirst = _txCount = _rxFirst = _rxCount = 0; // FIFO content is lost in SLEEP
+		}
+		_state = MARC_STATE_IDLE;
+		_readyAt = _now + XOSC_START_US;
+	}
+}
+
+// One full-duplex byte
+uint8_t CC1200Sim::Exchange(uint8_t mosi)
+{
+	uint8_t miso = _status();
+
+	switch (_phase)
+	{
+	case SPI_HEADER:
+	{
+		uint8_t address = mosi & 0x3F;
+		_read = (mosi & 0x80) != 0;
+		_burst = (mosi & 0x40) != 0;
+
+		if (address < 0x2F)
+		{
+			_addr = address;
+			_space = SPACE_REG;
+			_phase = SPI_DATA;
+		}
+		else if (address == 0x2F)
+		{
+			_phase = SPI_EXT_ADDR;
+		}
+		else if (address <= CC120X_SNOP)
+		{
+			_strobe(address);
+		}
+		else if (address == 0x3E)
+		{
+			_phase = SPI_DMA_ADDR;
+		}
+		else
+		{
+			_space = SPACE_FIFO;
+			_phase = SPI_DATA;
+		}
+		break;
+	}
+
+	case SPI_EXT_ADDR:
+		_addr = 0x2F00 | mosi;
+		_space = SPACE_REG;
+		_phase = SPI_DATA;
+		break;
+
+	case SPI_DMA_ADDR:
+		_addr = mosi;
+		_space = SPACE_DMA;
+		_phase = SPI_DATA;
+		break;
+
+	case SPI_DATA:
+		if (_space == SPACE_FIFO)
+		{
+			if (_read) miso = _fifoRead();
+			else _fifoWrite(mosi);
+		}
+		else if (_space == SPACE_DMA)
+		{
+			uint8_t *ram = (_addr & 0x80) ? &_RXFIFO[_addr & 0x7F] : &_TXFIFO[_addr & 0x7F];
+			if (_read) miso = *ram;
+			else *ram = mosi;
+			_addr = (_addr + 1) & 0xFF;
+		}
+		else
+		{
+			if (_read)
+			{
+				miso = _readReg(_addr);
+				Stats.REG_READS++;
+			}
+			else
+			{
+				_writeReg(_addr, mosi);
+				Stats.REG_WRITES++;
+			}
+			_addr = (_addr & 0xFF00) | ((_addr + 1) & 0xFF);
+		}
+
+		if (!_burst)
+		{
+			_phase = SPI_HEADER;
+		}
+		break;
+	}
+
+	_updateGpio();
+	return miso;
+}
+
+// CS released. Pending SPWD/SXOFF take effect now.
+void CC1200Sim::Deselect(void)
+{
+	if (_powerOnDeselect)
+	{
+		_abortPackets();
+		_state = _powerOnDeselect;
+		_transitionAt = SIM_NEVER;
+		_powerOnDeselect = 0;
+		_updateGpio();
+	}
+	_phase = SPI_HEADER;
+}
+
+/* Chip Model */
+// Status byte: CHIP_RDYn [7] | STATE [6:4]
+uint8_t CC1200Sim::_status(void)
+{
+	uint8_t state;
+
+	switch (_state)
+	{
+	case MARC_STATE_IDLE:		state = STATE_IDLE; break;
+	case MARC_STATE_RX:
+	case MARC_STATE_RX_END:
+	case MARC_STATE_RXDCM:		state = STATE_RX; break;
+	case MARC_STATE_TX:
+	case MARC_STATE_TX_END:		state = STATE_TX; break;
+	case MARC_STATE_FSTXON:		state = STATE_FSTXON; break;
+	case MARC_STATE_MANCAL:
+	case MARC_STATE_STARTCAL:
+	case MARC_STATE_ENDCAL:		state = STATE_CALIBRATE; break;
+	case MARC_STATE_RX_FIFO_ERR:	state = STATE_RX_FIFO_ERR; break;
+	case MARC_STATE_TX_FIFO_ERR:	state = STATE_TX_FIFO_ERR; break;
+	default:					state = STATE_SETTLING; break;
+	}
+
+	bool notReady = !_ready() || _state == MARC_STATE_SLEEP || _state == MARC_STATE_XOFF;
+	return (notReady ? 0x80 : 0x00) | (state << 4);
+}
+
+// Duration of one byte on air (us)
+uint32_t CC1200Sim::_byteUs(void)
+{
+	uint8_t modFormat = (_REGS[CC120X_MODCFG_DEV_E] >> 3) & 0x07;
+	uint8_t bitsPerSymbol = (modFormat == 4 || modFormat == 5) ? 2 : 1; // 4-FSK / 4-GFSK
+	uint32_t bitRate = SymbolRate() * bitsPerSymbol;
+	uint32_t us = bitRate ? (8000000UL / bitRate) : 8000000UL;
+	return us ? us : 1;
+}
+
+// Preamble + sync word length (bytes, rounded up)
+uint8_t CC1200Sim::_headBytes(void)
+{
+	uint16_t bits = SIM_PREAMBLE_BITS[(_REGS[CC120X_PREAMBLE_CFG1] >> 2) & 0x0F] + SIM_SYNC_BITS[_REGS[CC120X_SYNC_CFG1] >> 5];
+	return (bits + 7) / 8;
+}
+
+// WOR timer value at host time at: 40 kHz RC oscillator (WOR_RES = 0) since SWORRST, RCOSC_PPM fast
+uint16_t CC1200Sim::_worTicks(uint32_t at)
+{
+	return (uint16_t)((int64_t)(uint32_t)(at - _worBase) * (1000000L + RCOSC_PPM) / (1000000L * 25));
+}
+
+uint8_t CC1200Sim::_crcBytes(void)
+{
+	return ((_REGS[CC120X_PKT_CFG1] >> 1) & 0x03) ? 2 : 0;
+}
+
+uint32_t CC1200Sim::_freq(void)
+{
+	return ((uint32_t)_EXT[lowByte(CC120X_FREQ2)] << 16) | ((uint16_t)_EXT[lowByte(CC120X_FREQ1)] << 8) | _EXT[lowByte(CC120X_FREQ0)];
+}
+
+// Registers to defaults, FIFOs empty, IDLE
+void CC1200Sim::_reset(void)
+{
+	memcpy(_REGS, SIM_REG_DEFAULTS, sizeof(_REGS));
+	memset(_EXT, 0, sizeof(_EXT));
+	_EXT[lowByte(CC120X_PARTNUMBER)] = 0x20;	// CC1200
+	_EXT[lowByte(CC120X_PARTVERSION)] = 0x11;
+
+	_txFirst = _txCount = _rxFirst = _rxCount = 0;
+	_phase = SPI_HEADER;
+	_powerOnDeselect = 0;
+	_state = _nextState = MARC_STATE_IDLE;
+	_transitionAt = SIM_NEVER;
+	_marcStatus1 = _marcStatus0 = 0;
+	_txUnderflow = _rxOverflow = _rxUnderflow = false;
+	_sync = _crcOkOut = _rxPktEnd = false;
+	_rnd = 0xACE1;
+	_txActive = false;
+	_txNextAt = _txEndAt = SIM_NEVER;
+	_airTxLen = _lastTxLen = 0;
+	_airRxActive = false;
+	_airRxNextAt = SIM_NEVER;
+	_aesRun = false;
+	_updateGpio();
+}
+
+// Command strobe
+void CC1200Sim::_strobe(uint8_t command)
+{
+	Stats.STROBES++;
+	uint8_t autoCal = (_REGS[CC120X_SETTLING_CFG] >> 3) & 0x03;
+
+	switch (command)
+	{
+	case CC120X_SRES:
+		_reset();
+		_readyAt = _now + RESET_US;
+		break;
+
+	case CC120X_SFSTXON:
+	case CC120X_SRX:
+	case CC120X_STX:
+	case CC120X_SWOR: // eWOR modelled as continuous RX
+	{
+		uint8_t target = (command == CC120X_SFSTXON) ? MARC_STATE_FSTXON : (command == CC120X_STX) ? MARC_STATE_TX : MARC_STATE_RX;
+
+		if (_state == MARC_STATE_IDLE)
+		{
+			if (autoCal == 1 || autoCal == 3) // IDLE -> RX/TX
+			{
+				_calibrate();
+				_state = MARC_STATE_STARTCAL;
+				_goto(target, CAL_US + SETTLE_US);
+			}
+			else
+			{
+				_state = MARC_STATE_FS_LOCK;
+				_goto(target, SETTLE_US);
+			}
+		}
+		else if (_state == MARC_STATE_RX && target == MARC_STATE_TX)
+		{
+			if (_clearChannel())
+			{
+				_marcStatus0 &= ~(MARC_STATUS0_TXONCCA_FAILED_BSY << 2);
+				_abortPackets();
+				_state = MARC_STATE_RXTX_SWITCH;
+				_goto(MARC_STATE_TX, TURNAROUND_US);
+			}
+			else
+			{
+				_marcStatus0 |= (MARC_STATUS0_TXONCCA_FAILED_BSY << 2);
+				_event(MARC_STATUS1_OUT_TXONCCA_FAILED); // Remain in RX
+			}
+		}
+		else if (_state == MARC_STATE_FSTXON || (_state == MARC_STATE_TX && target == MARC_STATE_RX))
+		{
+			_abortPackets();
+			_state = MARC_STATE_TXRX_SWITCH;
+			_goto(target, TURNAROUND_US);
+		}
+		break;
+	}
+
+	case CC120X_SXOFF:
+		if (_state == MARC_STATE_IDLE) _powerOnDeselect = MARC_STATE_XOFF;
+		break;
+
+	case CC120X_SCAL:
+		if (_state == MARC_STATE_IDLE)
+		{
+			_calibrate();
+			_state = MARC_STATE_MANCAL;
+			_goto(MARC_STATE_IDLE, CAL_US);
+		}
+		break;
+
+	case CC120X_SIDLE:
+		_abortPackets();
+		_enter(MARC_STATE_IDLE);
+		break;
+
+	case CC120X_SPWD:
+		_powerOnDeselect = MARC_STATE_SLEEP;
+		break;
+
+	case CC120X_SFRX:
+		if (_state == MARC_STATE_IDLE || _state == MARC_STATE_RX_FIFO_ERR)
+		{
+			_rxFirst = _rxCount = 0;
+			_rxOverflow = _rxUnderflow = _rxPktEnd = false;
+			_state = MARC_STATE_IDLE;
+		}
+		break;
+
+	case CC120X_SFTX:
+		if (_state == MARC_STATE_IDLE || _state == MARC_STATE_TX_FIFO_ERR)
+		{
+			_txFirst = _txCount = 0;
+			_txUnderflow = false;
+			_state = MARC_STATE_IDLE;
+		}
+		break;
+
+	case CC120X_SWORRST:
+		_worBase = _now;
+		break;
+
+	default: // SAFC, SNOP
+		break;
+	}
+}
+
+// Schedule a state change delayUs from now
+void CC1200Sim::_goto(uint8_t state, uint32_t delayUs)
+{
+	if (delayUs == 0)
+	{
+		_enter(state);
+		return;
+	}
+	_nextState = state;
+	_transitionAt = _now + delayUs;
+}
+
+void CC1200Sim::_enter(uint8_t state)
+{
+	_state = state;
+	_transitionAt = SIM_NEVER;
+
+	if (state == MARC_STATE_TX) _enterTx();
+	else if (state == MARC_STATE_RX) _enterRx();
+}
+
+// Start a packet: preamble and sync, then bytes pulled from the TX FIFO
+void CC1200Sim::_enterTx(void)
+{
+	if (_REGS[CC120X_PKT_CFG2] & 0x03) // Serial/transparent PKT_FORMAT: the packet engine and TX FIFO are bypassed
+	{
+		_txActive = false;
+		_txNextAt = _txEndAt = SIM_NEVER;
+		return;
+	}
+	_txActive = true;
+	_txAnyByte = false;
+	_txLen = -1;
+	_txSent = 0;
+	_airTxLen = 0;
+	_txEndAt = SIM_NEVER;
+	_txNextAt = _now + (uint32_t)_headBytes() * _byteUs();
+}
+
+void CC1200Sim::_enterRx(void)
+{
+	_crcOkOut = false;
+}
+
+// Calibrate the frequency synthesizer for the programmed frequency
+void CC1200Sim::_calibrate(void)
+{
+	uint32_t freq = _freq();
+	_EXT[lowByte(CC120X_FS_VCO2)] = (uint8_t)(((freq >> 12) ^ 0x5A) & 0x7F);
+	_EXT[lowByte(CC120X_FS_VCO4)] = (uint8_t)((freq >> 7) & 0x1F);
+	_EXT[lowByte(CC120X_FS_CHP)] = (uint8_t)(0x20 | ((freq >> 14) & 0x1F));
+	Stats.CALIBRATIONS++;
+}
+
+// Abort frame in progress (TX, or RX past the sync word)
+void CC1200Sim::_abortPackets(void)
+{
+	_txActive = false;
+	_txNextAt = _txEndAt = SIM_NEVER;
+	if (_airRxActive && _airRxSynced)
+	{
+		_airRxActive = false;
+		_airRxNextAt = SIM_NEVER;
+		Stats.RX_DROPPED++;
+	}
+	_sync = false;
+}
+
+void CC1200Sim::_fifoError(uint8_t state, uint8_t cause)
+{
+	_abortPackets();
+	_state = state;
+	_transitionAt = SIM_NEVER;
+	Stats.FIFO_ERRORS++;
+	_event(cause);
+}
+
+// MARC_STATUS1 event (MCU_WAKEUP)
+void CC1200Sim::_event(uint8_t cause)
+{
+	_marcStatus1 = cause;
+}
+
+// CCA as configured by PKT_CFG2.CCA_MODE and AGC_CS_THR
+bool CC1200Sim::_clearChannel(void)
+{
+	int8_t rssi = _airRxActive ? _airRxRssi : _channelRssi;
+	bool belowThr = rssi < (int8_t)_REGS[CC120X_AGC_CS_THR];
+	bool receiving = _airRxActive && _airRxSynced;
+
+	switch ((_REGS[CC120X_PKT_CFG2] >> 2) & 0x07)
+	{
+	case 0:  return true;
+	case 1:  return belowThr;
+	case 2:  return !receiving;
+	case 3:  return belowThr && !receiving;
+	default: return belowThr;
+	}
+}
+
+uint8_t CC1200Sim::_readReg(uint16_t address)
+{
+	if ((address >> 8) != 0x2F)
+	{
+		return (address < 0x2F) ? _REGS[address] : 0x00;
+	}
+
+	uint8_t thr = _REGS[CC120X_FIFO_CFG] & FIFO_CFG_FIFO_THR;
+	bool rx = (_state == MARC_STATE_RX);
+	int8_t rssi = _airRxActive && _airRxSynced ? _airRxRssi : _channelRssi;
+
+	if (address == CC120X_AES || address >= CC120X_AES_BUFFER)
+	{
+		_aesUpdate();
+	}
+
+	switch (address)
+	{
+	case CC120X_MARCSTATE:
+	{
+		uint8_t pin = MARC_STATE_2PIN_SETTLING;
+		if (_state == MARC_STATE_IDLE) pin = MARC_STATE_2PIN_IDLE;
+		else if (_state >= MARC_STATE_RX && _state <= MARC_STATE_RXDCM) pin = MARC_STATE_2PIN_RX;
+		else if (_state == MARC_STATE_TX || _state == MARC_STATE_TX_END) pin = MARC_STATE_2PIN_TX;
+		return (pin << 5) | _state;
+	}
+	case CC120X_NUM_TXBYTES:		return _txCount;
+	case CC120X_NUM_RXBYTES:		return _rxCount;
+	case CC120X_FIFO_NUM_TXBYTES:	return min(FIFO_SIZE_BYTES - _txCount, 15);
+	case CC120X_FIFO_NUM_RXBYTES:	return min((int)_rxCount, 15);
+	case CC120X_TXFIRST:			return _txFirst;
+	case CC120X_TXLAST:				return (_txFirst + _txCount) % FIFO_SIZE_BYTES;
+	case CC120X_RXFIRST:			return _rxFirst;
+	case CC120X_RXLAST:				return (_rxFirst + _rxCount) % FIFO_SIZE_BYTES;
+	case CC120X_MODEM_STATUS1:
+		return ((_sync && rx) ? MODEM_STATUS1_SYNC_FOUND : 0)
+			| ((_rxCount == FIFO_SIZE_BYTES) ? MODEM_STATUS1_RXFIFO_FULL : 0)
+			| ((_rxCount >= thr + 1) ? MODEM_STATUS1_RXFIFO_THR : 0)
+			| ((_rxCount == 0) ? MODEM_STATUS1_RXFIFO_EMPTY : 0)
+			| (_rxOverflow ? MODEM_STATUS1_RXFIFO_OVERFLOW : 0)
+			| (_rxUnderflow ? MODEM_STATUS1_RXFIFO_UNDERFLOW : 0);
+	case CC120X_MODEM_STATUS0:
+		return ((_sync && _txActive) ? MODEM_STATUS0_SYNC_SENT : 0)
+			| ((_txCount == FIFO_SIZE_BYTES) ? MODEM_STATUS0_TXFIFO_FULL : 0)
+			| ((_txCount >= 127 - thr) ? MODEM_STATUS0_TXFIFO_THR : 0);
+	case CC120X_MARC_STATUS1:
+	{
+		uint8_t cause = _marcStatus1;
+		_marcStatus1 = 0; // Cleared on read
+		return cause;
+	}
+	case CC120X_MARC_STATUS0:		return _marcStatus0;
+	case CC120X_RSSI1:				return (uint8_t)rssi;
+	case CC120X_RSSI0:
+		return rx ? (0x03 | ((rssi >= (int8_t)_REGS[CC120X_AGC_CS_THR]) ? 0x04 : 0x00)) : 0x00;
+	case CC120X_WOR_TIME1:			return highByte(_worTicks(_now));
+	case CC120X_WOR_TIME0:			return lowByte(_worTicks(_now));
+	case CC120X_RNDGEN:
+		if (_EXT[lowByte(CC120X_RNDGEN)] & 0x80)
+		{
+			_rnd = (_rnd >> 1) ^ (-(_rnd & 1) & 0xB400); // 16-bit Galois LFSR
+			return 0x80 | (_rnd & 0x7F);
+		}
+		return _EXT[lowByte(CC120X_RNDGEN)];
+	case CC120X_GPIO_STATUS:
+		return (_gpioLevel[3] & 1) << 3 | (_gpioLevel[2] & 1) << 2 | (_gpioLevel[1] & 1) << 1 | (_gpioLevel[0] & 1);
+	default:
+		return _EXT[lowByte(address)];
+	}
+}
+
+void CC1200Sim::_writeReg(uint16_t address, uint8_t value)
+{
+	if ((address >> 8) != 0x2F)
+	{
+		if (address < 0x2F) _REGS[address] = value;
+		return;
+	}
+
+	uint8_t low = lowByte(address);
+	bool statusSpace = (low >= lowByte(CC120X_WOR_TIME1) && low <= lowByte(CC120X_RXFIFO_PRE_BUF));
+	if (statusSpace && address != CC120X_RNDGEN && address != CC120X_CFM_TX_DATA_IN && address != CC120X_AES)
+	{
+		return; // Read-only
+	}
+	_EXT[low] = value;
+
+	if (address == CC120X_CFM_TX_DATA_IN && _state == MARC_STATE_TX && (_EXT[lowByte(CC120X_MDMCFG2)] & 0x01))
+	{
+		Stats.CFM_SAMPLES++;
+		if (_PEER && _PEER->_state == MARC_STATE_RX && (_PEER->_EXT[lowByte(CC120X_MDMCFG2)] & 0x01))
+		{
+			_PEER->_EXT[lowByte(CC120X_CFM_RX_DATA_OUT)] = value;
+		}
+	}
+
+	if (address == CC120X_AES)
+	{
+		if (value & 0x02) // AES_ABORT
+		{
+			_aesRun = false;
+			_EXT[low] = 0x00;
+		}
+		else if (value & 0x01) // AES_RUN: AES_BUFFER is replaced AES_US later
+		{
+			_aesUpdate();
+			_aesRun = true;
+			_aesDoneAt = _now + AES_US;
+		}
+	}
+}
+
+// Complete a running encryption once its time is up: AES_BUFFER = AES(AES_KEY, AES_BUFFER), AES_RUN cleared
+void CC1200Sim::_aesUpdate(void)
+{
+	if (!_aesRun || _now < _aesDoneAt)
+	{
+		return;
+	}
+	sim_aes_encrypt(&_EXT[lowByte(CC120X_AES_KEY)], &_EXT[lowByte(CC120X_AES_BUFFER)]);
+	_EXT[lowByte(CC120X_AES)] &= ~0x01;
+	_aesRun = false;
+	Stats.AES_BLOCKS++;
+}
+
+uint8_t CC1200Sim::_fifoRead(void)
+{
+	if (_rxCount == 0)
+	{
+		_rxUnderflow = true;
+		_fifoError(MARC_STATE_RX_FIFO_ERR, MARC_STATUS1_OUT_RX_FIFO_UNERR);
+		return 0x00;
+	}
+
+	uint8_t value = _RXFIFO[_rxFirst];
+	_rxFirst = (_rxFirst + 1) % FIFO_SIZE_BYTES;
+	_rxCount--;
+	if (_rxPushed > _rxCount) _rxPushed = _rxCount; // Bytes of the frame in progress already drained
+	if (_rxCount == 0) _rxPktEnd = false;
+	Stats.FIFO_READS++;
+	return value;
+}
+
+void CC1200Sim::_fifoWrite(uint8_t value)
+{
+	if (_txCount == FIFO_SIZE_BYTES)
+	{
+		_fifoError(MARC_STATE_TX_FIFO_ERR, MARC_STATUS1_OUT_TX_FIFO_OVERR);
+		return;
+	}
+
+	_TXFIFO[(_txFirst + _txCount) % FIFO_SIZE_BYTES] = value;
+	_txCount++;
+	Stats.FIFO_WRITES++;
+}
+
+/* Packet Engine */
+// Pull the next byte from the TX FIFO. Preamble continues until the first byte is available.
+void CC1200Sim::_txByte(void)
+{
+	if (_txCount == 0)
+	{
+		if (!_txAnyByte)
+		{
+			_txNextAt += _byteUs();
+			return;
+		}
+		_txUnderflow = true;
+		_fifoError(MARC_STATE_TX_FIFO_ERR, MARC_STATUS1_OUT_TX_FIFO_UNERR);
+		return;
+	}
+
+	_sync = true;
+	_txAnyByte = true;
+	uint8_t value = _TXFIFO[_txFirst];
+	_txFirst = (_txFirst + 1) % FIFO_SIZE_BYTES;
+	_txCount--;
+	if (_airTxLen < sizeof(_AIRTX)) _AIRTX[_airTxLen++] = value;
+
+	uint8_t lengthConfig = (_REGS[CC120X_PKT_CFG0] >> 5) & 0x03;
+	bool variable = (lengthConfig == 1 || lengthConfig == 3);
+	bool end = false;
+
+	if (variable && _txLen < 0)
+	{
+		_txLen = (lengthConfig == 3) ? (value & 0x1F) : value;
+		end = (_txLen == 0);
+	}
+	else
+	{
+		_txSent++;
+		if (variable) end = (_txSent >= _txLen);
+		else if (lengthConfig == 0) end = ((_txSent & 0xFF) == _REGS[CC120X_PKT_LEN]); // Fixed. PKT_LEN = 0 is 256.
+	}
+
+	if (end)
+	{
+		_txNextAt = SIM_NEVER;
+		_txEndAt = _now + (uint32_t)(1 + _crcBytes()) * _byteUs();
+	}
+	else
+	{
+		_txNextAt += _byteUs();
+	}
+}
+
+// Last byte and CRC sent
+void CC1200Sim::_txEnd(void)
+{
+	_txActive = false;
+	_txEndAt = SIM_NEVER;
+	_sync = false;
+	memcpy(_LASTTX, _AIRTX, _airTxLen);
+	_lastTxLen = _airTxLen;
+	Stats.TX_FRAMES++;
+	_event(MARC_STATUS1_OUT_TX_OK);
+	_updateGpio();
+
+	if (_PEER)
+	{
+		_lossSeed = _lossSeed * 1103515245UL + 12345UL;
+		if (_lossPercent && (_lossSeed >> 16) % 100 < _lossPercent) Stats.TX_LOST++;
+		else _PEER->_deliver(_LASTTX, _lastTxLen);
+	}
+
+	switch ((_REGS[CC120X_RFEND_CFG0] >> 4) & 0x03) // TXOFF_MODE
+	{
+	case 1:  _enter(MARC_STATE_FSTXON); break;
+	case 2:  _enterTx(); break;
+	case 3:  _state = MARC_STATE_TXRX_SWITCH; _goto(MARC_STATE_RX, TURNAROUND_US); break;
+	default: _enter(MARC_STATE_IDLE); break;
+	}
+}
+
+// Sync word detected at host time at (WOR_CAPTURE)
+void CC1200Sim::_rxSync(uint32_t at)
+{
+	if (_state != MARC_STATE_RX)
+	{
+		_airRxActive = false; // Not listening
+		_airRxNextAt = SIM_NEVER;
+		Stats.RX_DROPPED++;
+		return;
+	}
+
+	uint16_t wor = _worTicks(at);
+	_EXT[lowByte(CC120X_WOR_CAPTURE1)] = highByte(wor);
+	_EXT[lowByte(CC120X_WOR_CAPTURE0)] = lowByte(wor);
+	_airRxSynced = true;
+	_rxPushed = 0;
+	_crcOkOut = false;
+	_sync = true;
+}
+
+// Next byte of the frame into the RX FIFO, with length and address filtering
+void CC1200Sim::_rxByte(void)
+{
+	uint8_t value = _AIRRX[_airRxPos++];
+	if (!_rxPush(value)) return;
+
+	uint8_t lengthConfig = (_REGS[CC120X_PKT_CFG0] >> 5) & 0x03;
+	bool variable = (lengthConfig == 1 || lengthConfig == 3);
+	uint8_t addrCheck = (_REGS[CC120X_PKT_CFG1] >> 3) & 0x03;
+
+	if (variable && _airRxPos == 1 && value > _REGS[CC120X_PKT_LEN])
+	{
+		_rxDrop(MARC_STATUS1_OUT_PACKET_DROP_LEN);
+	}
+	else if (addrCheck && _airRxPos == (variable ? 2 : 1))
+	{
+		uint8_t devAddr = _REGS[CC120X_DEV_ADDR];
+		bool match = (value == devAddr) || (addrCheck >= 2 && value == 0x00) || (addrCheck == 3 && value == 0xFF);
+		if (!match) _rxDrop(MARC_STATUS1_OUT_PACKET_DROP_ADR);
+	}
+}
+
+// End of frame: CRC check, appended status bytes, RXOFF_MODE
+void CC1200Sim::_rxEnd(void)
+{
+	_airRxActive = false;
+	_airRxNextAt = SIM_NEVER;
+	_sync = false;
+
+	if (!_airRxCrcOk && _crcBytes() && (_REGS[CC120X_FIFO_CFG] & FIFO_CFG_CRC_AUTOFLUSH))
+	{
+		_rxDrop(MARC_STATUS1_OUT_PACKET_DROP_CRC);
+		return;
+	}
+
+	if (_REGS[CC120X_PKT_CFG1] & 0x01) // APPEND_STATUS: RSSI, CRC_OK | LQI
+	{
+		if (!_rxPush((uint8_t)_airRxRssi)) return;
+		if (!_rxPush((_airRxCrcOk ? CC120X_LQI_CRC_OK_BM : 0x00) | (_airRxLqi & CC120X_LQI_EST_BM))) return;
+	}
+
+	_crcOkOut = _airRxCrcOk;
+	_rxPktEnd = true;
+	Stats.RX_FRAMES++;
+	_event(MARC_STATUS1_OUT_RX_OK);
+
+	switch ((_REGS[CC120X_RFEND_CFG1] >> 4) & 0x03) // RXOFF_MODE
+	{
+	case 0:  _enter(MARC_STATE_IDLE); break;
+	case 1:  _enter(MARC_STATE_FSTXON); break;
+	case 2:  _state = MARC_STATE_RXTX_SWITCH; _goto(MARC_STATE_TX, TURNAROUND_US); break;
+	default: _enterRx(); break;
+	}
+	_updateGpio(); // End-of-packet edge after the RXOFF transition: the MCU sees the new state
+}
+
+// Discard the frame in progress from the RX FIFO and keep listening
+void CC1200Sim::_rxDrop(uint8_t cause)
+{
+	uint8_t n = min(_rxPushed, (uint16_t)_rxCount);
+	_rxCount -= n;
+	_rxPushed = 0;
+	_airRxActive = false;
+	_airRxNextAt = SIM_NEVER;
+	_sync = false;
+	Stats.RX_DROPPED++;
+	_event(cause);
+}
+
+bool CC1200Sim::_rxPush(uint8_t value)
+{
+	if (_rxCount == FIFO_SIZE_BYTES)
+	{
+		_rxOverflow = true;
+		_fifoError(MARC_STATE_RX_FIFO_ERR, MARC_STATUS1_OUT_RX_FIFO_OVERR);
+		return false;
+	}
+
+	_RXFIFO[(_rxFirst + _rxCount) % FIFO_SIZE_BYTES] = value;
+	_rxCount++;
+	_rxPushed++;
+	return true;
+}
+
+// Frame from a linked peer. Its airtime has elapsed on the sender, so it is received at once.
+void CC1200Sim::_deliver(const uint8_t *frame, uint16_t len)
+{
+	Tick();
+	if (_airRxActive)
+	{
+		Stats.RX_DROPPED++; // Collision
+		return;
+	}
+
+	memcpy(_AIRRX, frame, len);
+	_airRxLen = len;
+	_airRxPos = 0;
+	_airRxRssi = -40;
+	_airRxLqi = 0x10;
+	_airRxCrcOk = true;
+	_airRxSynced = false;
+	_airRxActive = true;
+
+	_rxSync(_now - (uint32_t)(len + _crcBytes()) * _byteUs()); // Delivered whole at TX end
+	_updateGpio();
+	while (_airRxActive && _airRxPos < _airRxLen)
+	{
+		_rxByte();
+	}
+	if (_airRxActive) _rxEnd();
+	_updateGpio();
+}
+
+/* Event Loop */
+uint32_t CC1200Sim::_nextEvent(void)
+{
+	uint32_t next = _transitionAt;
+	if (_txActive) next = min(next, min(_txNextAt, _txEndAt));
+	if (_airRxActive) next = min(next, _airRxNextAt);
+	return next;
+}
+
+// Run events in time order up to until
+void CC1200Sim::_runEvents(uint32_t until)
+{
+	uint32_t next;
+
+	while ((next = _nextEvent()) <= until)
+	{
+		if (next > _now) _now = next;
+
+		if (_transitionAt == next)
+		{
+			_enter(_nextState);
+		}
+		else if (_txActive && _txNextAt == next)
+		{
+			_txByte();
+		}
+		else if (_txActive && _txEndAt == next)
+		{
+			_txEnd();
+		}
+		else if (_airRxActive && _airRxNextAt == next)
+		{
+			if (!_airRxSynced)
+			{
+				_rxSync(_now);
+				if (_airRxActive) _airRxNextAt = _now + _byteUs();
+			}
+			else if (_airRxPos < _airRxLen)
+			{
+				_rxByte();
+				if (_airRxActive) _airRxNextAt = _now + ((_airRxPos < _airRxLen) ? _byteUs() : (uint32_t)_crcBytes() * _byteUs());
+			}
+			else
+			{
+				_rxEnd();
+			}
+		}
+		_updateGpio();
+	}
+
+	if (until > _now) _now = until;
+	_updateGpio();
+}
+
+/* GPIO */
+bool CC1200Sim::_gpioSignal(uint8_t cfg)
+{
+	uint8_t thr = _REGS[CC120X_FIFO_CFG] & FIFO_CFG_FIFO_THR;
+	bool rx = (_state == MARC_STATE_RX);
+	int8_t rssi = _airRxActive && _airRxSynced ? _airRxRssi : _channelRssi;
+
+	switch (cfg)
+	{
+	case GPIO_RXFIFO_THR:			return _rxCount >= thr + 1;
+	case GPIO_RXFIFO_THR_PKT:		return _rxCount >= thr + 1 || (_rxPktEnd && _rxCount > 0);
+	case GPIO_TXFIFO_THR:
+	case GPIO_TXFIFO_THR_PKT:		return _txCount >= 127 - thr;
+	case GPIO_RXFIFO_OVERFLOW:		return _rxOverflow;
+	case GPIO_TXFIFO_UNDERFLOW:		return _txUnderflow;
+	case GPIO_PKT_SYNC_RXTX:		return _sync;
+	case GPIO_PKT_CRC_OK:			return _crcOkOut;
+	case GPIO_RSSI_VALID:
+	case GPIO_CARRIER_SENSE_VALID:	return rx;
+	case GPIO_CARRIER_SENSE:		return rx && rssi >= (int8_t)_REGS[CC120X_AGC_CS_THR];
+	case GPIO_MCU_WAKEUP:			return _marcStatus1 != 0;
+	case GPIO_CHIP_RDYn:			return !_ready();
+	default:						return false;
+	}
+}
+
+// Drive connected host pins. Edges fire attached host interrupts.
+void CC1200Sim::_updateGpio(void)
+{
+	for (uint8_t gpio = 0; gpio < 4; gpio++)
+	{
+		uint8_t cfg = _REGS[CC120X_IOCFG0 - gpio]; // IOCFG3..0 at 0x00..0x03
+		uint8_t level = (_gpioSignal(cfg & 0x3F) ^ ((cfg & GPIO_INV) != 0)) ? HIGH : LOW;
+
+		if (level != _gpioLevel[gpio])
+		{
+			_gpioLevel[gpio] = level;
+			if (_GPIO_PIN[gpio] >= 0) digitalWrite(_GPIO_PIN[gpio], level);
+		}
+	}
+}
+
+void CC1200Sim::_tickAll(void)
+{
+	for (uint8_t i = 0; i < 4 && _ACTIVE[i]; i++)
+	{
+		_ACTIVE[i]->Tick();
+	}
+}
+
+#endif // !ARDUINO
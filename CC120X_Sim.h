@@ -0,0 +1,189 @@
+#ifndef _CC120X_SIM_H
+#define _CC120X_SIM_H
+
+/* =====================================================================================================================
+												CC1200 CHIP SIMULATOR (HOST)
+  ===================================================================================================================== */
+// Register-level model of the CC1200 sitting behind HostSpiTransport. It decodes the SPI header byte exactly
+// like the chip (R/W, burst, normal/extended/strobe/DMA/FIFO space), answers with the status byte and keeps
+// the MARC state machine, 128-byte TX/RX FIFOs, GPIO outputs and packet engine in step with the virtual
+// clock of CC120X_Host.h. The unmodified CC1200.cpp runs against it, so every operation can be measured in
+// SPI bytes and simulated microseconds, and every field issue can be replayed deterministically.
+//
+// Model limits: no RF/modem; packets are injected with InjectPacket() or delivered from a linked peer.
+// eWOR is modelled as continuous RX. Custom frequency modulation passes CFM_TX_DATA_IN to CFM_RX_DATA_OUT of a
+// linked peer in RX. Extended registers not read back by the driver reset to 0x00.
+
+#include "CC1200.h"
+
+#if !defined(ARDUINO)
+
+// Simulator accounting
+typedef struct SimStats
+{
+	uint32_t STROBES;			// Command strobes executed
+	uint32_t REG_READS;			// Register bytes read
+	uint32_t REG_WRITES;		// Register bytes written
+	uint32_t FIFO_READS;		// RX FIFO bytes read
+	uint32_t FIFO_WRITES;		// TX FIFO bytes written
+	uint32_t TX_FRAMES;			// Frames sent on air
+	uint32_t RX_FRAMES;			// Frames accepted into the RX FIFO
+	uint32_t RX_DROPPED;		// Frames filtered (length/address/CRC) or missed (not in RX)
+	uint32_t FIFO_ERRORS;		// TX/RX FIFO over/underflows
+	uint32_t CALIBRATIONS;		// Frequency synthesizer calibrations
+	uint32_t AES_BLOCKS;		// AES-128 encryptions
+	uint32_t CFM_SAMPLES;		// CFM_TX_DATA_IN writes sent on air (TX, MDMCFG2.CFM_DATA_EN)
+	uint32_t TX_LOST;			// Frames sent on air but not delivered to the linked peer (SetLoss)
+} simStats_t;
+
+class CC1200Sim : public HostSpiDevice
+{
+public:
+	// Timing model (microseconds)
+	uint16_t RESET_US = 250;		// SRES / power-on until CHIP_RDYn goes LOW
+	uint16_t XOSC_START_US = 250;	// Wake-up from SLEEP/XOFF
+	uint16_t CAL_US = 400;			// Frequency synthesizer calibration
+	uint16_t SETTLE_US = 75;		// IDLE -> RX/TX/FSTXON without calibration
+	uint16_t TURNAROUND_US = 40;	// RX <-> TX, FSTXON -> RX/TX
+	uint16_t AES_US = 10;			// AES_RUN until AES_BUFFER holds the cipher text
+	int16_t RCOSC_PPM = 0;			// WOR timer (40 kHz RC oscillator) rate error against the host clock
+
+	simStats_t Stats;
+
+	CC1200Sim(void);
+
+	void Attach(uint8_t ssPin = SS);					// Put this chip behind HostSpiTransport
+	void PowerOn(void);									// Power-on reset (registers to defaults)
+	void ConnectGpio(uint8_t gpio, int16_t hostPin);	// Drive host pin from GPIOx output (-1: none)
+	void Link(CC1200Sim *peer);							// Frames sent on air are received by peer
+	void SetChannelRssi(int8_t dBm);					// RSSI seen on the channel (carrier sense / CCA)
+	void SetLoss(uint8_t percent, uint32_t seed = 1);	// Frames to the linked peer lost at random
+
+	// Schedule a frame on air [Length Address --Payload--]. Preamble/sync start now.
+	bool InjectPacket(const uint8_t *frame, uint16_t len, int8_t rssi = -60, uint8_t lqi = 0x20, bool crcOk = true);
+
+	// Inspection without side effects
+	uint8_t Peek(uint16_t address);
+	void Poke(uint16_t address, uint8_t value);
+	uint8_t MarcState(void) { return _state; }
+	uint8_t TxFifoCount(void) { return _txCount; }
+	uint8_t RxFifoCount(void) { return _rxCount; }
+	uint16_t LastTxFrame(uint8_t *buffer);				// Last frame sent on air. Returns its length.
+	bool FsCalibrated(void);							// FS calibration registers match FREQ2..0
+	uint32_t SymbolRate(void);							// Symbols per second from SYMBOL_RATE2..0
+
+	// Process pending events up to the host clock
+	void Tick(void);
+
+	// HostSpiDevice
+	void Select(void);
+	uint8_t Exchange(uint8_t mosi);
+	void Deselect(void);
+	bool Ready(void);
+
+private:
+	enum SpiPhase { SPI_HEADER, SPI_EXT_ADDR, SPI_DMA_ADDR, SPI_DATA };
+	enum Space { SPACE_REG, SPACE_FIFO, SPACE_DMA };
+
+	// Registers
+	uint8_t _REGS[0x2F];				// Normal space 0x00-0x2E
+	uint8_t _EXT[0x100];				// Extended space 0x2F00-0x2FFF
+
+	// FIFOs (rings with first/last pointers as in RXFIRST/RXLAST, TXFIRST/TXLAST)
+	uint8_t _TXFIFO[FIFO_SIZE_BYTES], _RXFIFO[FIFO_SIZE_BYTES];
+	uint8_t _txFirst, _txCount, _rxFirst, _rxCount;
+
+	// SPI transaction
+	SpiPhase _phase;
+	Space _space;
+	bool _read, _burst;
+	uint16_t _addr;
+	uint8_t _powerOnDeselect;			// SPWD/SXOFF take effect when CS goes HIGH
+
+	// MARC
+	uint8_t _state, _nextState;
+	uint32_t _now, _readyAt, _transitionAt, _worBase;
+	uint8_t _marcStatus1, _marcStatus0;
+	bool _txUnderflow, _rxOverflow, _rxUnderflow;
+	bool _sync, _crcOkOut, _rxPktEnd;
+	int8_t _channelRssi;
+	uint16_t _rnd;
+
+	// TX packet engine
+	bool _txActive, _txAnyByte;
+	int16_t _txLen;						// Variable length byte, -1 until seen
+	uint16_t _txSent;
+	uint32_t _txNextAt, _txEndAt;
+	uint8_t _AIRTX[1024];
+	uint16_t _airTxLen, _lastTxLen;
+	uint8_t _LASTTX[1024];
+
+	// RX packet engine (one frame on air at a time)
+	uint8_t _AIRRX[1024];
+	uint16_t _airRxLen, _airRxPos, _rxPushed;
+	bool _airRxActive, _airRxSynced, _airRxCrcOk;
+	int8_t _airRxRssi;
+	uint8_t _airRxLqi;
+	uint32_t _airRxNextAt;
+
+	// GPIO
+	int16_t _GPIO_PIN[4];
+	uint8_t _gpioLevel[4];
+
+	// AES engine
+	bool _aesRun;
+	uint32_t _aesDoneAt;
+
+	CC1200Sim *_PEER;
+	uint8_t _lossPercent;
+	uint32_t _lossSeed;
+	bool _inTick;
+
+	uint8_t _status(void);
+	bool _ready(void) { return _now >= _readyAt; }
+	uint32_t _byteUs(void);
+	uint8_t _headBytes(void);
+	uint8_t _crcBytes(void);
+	uint32_t _freq(void);
+	uint16_t _worTicks(uint32_t at);
+
+	void _reset(void);
+	void _wake(void);
+	void _strobe(uint8_t command);
+	void _goto(uint8_t state, uint32_t delayUs);
+	void _enter(uint8_t state);
+	void _enterTx(void);
+	void _enterRx(void);
+	void _calibrate(void);
+	void _abortPackets(void);
+	void _fifoError(uint8_t state, uint8_t cause);
+	void _event(uint8_t cause);
+	bool _clearChannel(void);
+	void _aesUpdate(void);
+
+	uint8_t _readReg(uint16_t address);
+	void _writeReg(uint16_t address, uint8_t value);
+	uint8_t _fifoRead(void);
+	void _fifoWrite(uint8_t value);
+
+	void _txByte(void);
+	void _txEnd(void);
+	void _rxSync(uint32_t at);
+	void _rxByte(void);
+	void _rxEnd(void);
+	void _rxDrop(uint8_t cause);
+	bool _rxPush(uint8_t value);
+	void _deliver(const uint8_t *frame, uint16_t len);
+
+	uint32_t _nextEvent(void);
+	void _runEvents(uint32_t until);
+	bool _gpioSignal(uint8_t cfg);
+	void _updateGpio(void);
+
+	static CC1200Sim *_ACTIVE[4];		// Instances driven by the host tick hook
+	static void _tickAll(void);
+};
+
+#endif // !ARDUINO
+
+#endif // !_CC120X_SIM_H
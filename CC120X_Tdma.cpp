@@ -0,0 +1,529 @@
+/*
+
+Copyright (c) 2018 Md Abdullah AL IMRAN | alimran.mdabdullah@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ 1. Redistributions of source code must retain the above copyright
+	notice, this list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright
+	notice, this list of conditions and the following disclaimer in the
+	documentation and/or other materials provided with the distribution.
+ 3. The name of the author may not be used to endorse or promote products
+	derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "CC120X_Tdma.h"
+
+#define TDMA_GUARD_TICKS	((uint16_t)(TDMA_GUARD_US / TDMA_TICK_US))
+#define TDMA_WAKE_TICKS		((uint16_t)(TDMA_WAKE_US / TDMA_TICK_US))
+
+CC1200Tdma::CC1200Tdma(CC1200 &radio) : _radio(radio)
+{
+	_coordinator = false;
+	_coordinatorAddress = BROADCAST_ADDRESS000;
+	memset(_ROLES, TDMA_SLEEP, sizeof(_ROLES));
+	_slots = 0;
+	_slotTicks = _periodTicks = 0;
+	_leadTicks = _beaconTicks = 0;
+	_ref = 0;
+	_missed = 0;
+	_driftPpm = 0;
+	_sequence = 0;
+	_txFrame = NULL;
+	_slotMark = 0;
+	_slotMarked = false;
+	_mode = TDMA_IDLE;
+	_wakeAt = _statsAt = 0;
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+// Run the superframe: a beacon every (slots + 1) * slotUs, slots 1 .. slots listening (SetSlot() changes them).
+// FALSE if the superframe does not fit the WOR timer (TDMA_PERIOD_MAX_US, beacon air time).
+bool CC1200Tdma::BeginCoordinator(uint8_t slots, uint32_t slotUs)
+{
+	_begin();
+	uint32_t slotTicks = slotUs / TDMA_TICK_US;
+	if (slots == 0 || slots > TDMA_MAX_SLOTS || slotTicks == 0 || !_fits(slotTicks * (slots + 1)))
+	{
+		return false;
+	}
+
+	_coordinator = true;
+	_slots = slots;
+	_slotTicks = slotTicks;
+	_periodTicks = slotTicks * (slots + 1);
+	for (uint8_t i = 1; i <= slots; i++)
+	{
+		_ROLES[i] = TDMA_RX;
+	}
+	_ref = _wor_now() - _periodTicks; // First beacon now
+	_state = TDMA_SYNCED;
+	return true;
+}
+
+// Listen for the beacons of coordinator (BROADCAST_ADDRESS000: any) and follow its superframe. All slots sleep
+// until SetSlot() assigns them.
+void CC1200Tdma::BeginNode(uint8_t coordinator)
+{
+	_begin();
+	_coordinator = false;
+	_coordinatorAddress = coordinator;
+	_state = TDMA_SEARCH;
+	_radio_mode(TDMA_RX);
+}
+
+// Stop scheduling. The radio is left in IDLE.
+void CC1200Tdma::End(void)
+{
+	if (_state == TDMA_OFF)
+	{
+		return;
+	}
+	if (_mode != TDMA_SLEEP)
+	{
+		_stats.RADIO_ON_US += micros() - _wakeAt;
+	}
+	_radio.Idle();
+	_mode = TDMA_IDLE;
+	_state = TDMA_OFF;
+}
+
+// Role of slot 1 .. TDMA_MAX_SLOTS: TDMA_TX (own), TDMA_RX (listen) or TDMA_SLEEP. Call after Begin*().
+void CC1200Tdma::SetSlot(uint8_t slot, uint8_t role)
+{
+	if (slot >= 1 && slot <= TDMA_MAX_SLOTS && role <= TDMA_RX)
+	{
+		_ROLES[slot] = role;
+	}
+}
+
+// Shortest slot for frames of frameBytes (length byte included) at the configured PHY: STX, air time, guards
+uint32_t CC1200Tdma::MinSlotUs(uint8_t frameBytes)
+{
+	return _radio.AirTimeUs(frameBytes) + TDMA_TX_START_US + 2 * TDMA_GUARD_US;
+}
+
+// Send frame [Length Target Source ...] in the next own slot. The frame is not copied and must stay unchanged until
+// TxPending() is FALSE. FALSE if a frame is pending already or no slot is TDMA_TX.
+bool CC1200Tdma::Send(byte frame[])
+{
+	if (_state == TDMA_OFF || _txFrame != NULL || frame[0] < 2)
+	{
+		return false;
+	}
+	for (uint8_t i = 1; i <= TDMA_MAX_SLOTS; i++)
+	{
+		if (_ROLES[i] == TDMA_TX)
+		{
+			_txFrame = frame;
+			return true;
+		}
+	}
+	return false;
+}
+
+// Frame given to Send() not on air yet
+bool CC1200Tdma::TxPending(void)
+{
+	return (_txFrame != NULL);
+}
+
+// Hand over a frame from the received-frame queue. TRUE if it was a beacon (consumed).
+bool CC1200Tdma::Receive(const rxFrame_t *frame)
+{
+	if (!frame->CRC_OK || frame->LEN < TDMA_BEACON_LEN + 1 || frame->DATA[0] + 1 != frame->LEN)
+	{
+		return false;
+	}
+	return Receive(frame->DATA, frame->LEN);
+}
+
+// Hand over a frame as read by ReadRxFifo(), with or without the appended status bytes. A beacon synchronizes the
+// node to the sync word timestamp (WOR_CAPTURE) of the frame last received, so hand it over before the next one
+// arrives. TRUE if it was a beacon (consumed).
+bool CC1200Tdma::Receive(const byte frame[], uint8_t len)
+{
+	if (frame[0] != TDMA_BEACON_LEN || len < TDMA_BEACON_LEN + 1 || frame[3] != TDMA_BEACON)
+	{
+		return false;
+	}
+	if (len == TDMA_BEACON_LEN + 3 && !(frame[len - 1] & CC120X_LQI_CRC_OK_BM))
+	{
+		return false;
+	}
+	if (_coordinator || _state == TDMA_OFF ||
+		(_coordinatorAddress != BROADCAST_ADDRESS000 && frame[2] != _coordinatorAddress))
+	{
+		return true;
+	}
+
+	byte value[2];
+	_radio.ReadRegister(CC120X_WOR_CAPTURE1, value, 2);
+	uint16_t capture = (value[0] << 8) | value[1];
+	uint8_t slots = frame[5];
+	uint16_t slotTicks = (frame[6] << 8) | frame[7];
+	if (slots == 0 || slots > TDMA_MAX_SLOTS || slotTicks == 0 || !_fits((uint32_t)slotTicks * (slots + 1)))
+	{
+		return true;
+	}
+
+	if (_state == TDMA_SYNCED && slots == _slots && slotTicks == _slotTicks)
+	{
+		// Capture against the prediction. Service() may have moved _ref past a beacon window already.
+		uint16_t period = _scale(_periodTicks);
+		int16_t error = (int16_t)(capture - (uint16_t)(_ref + period));
+		uint8_t periods = _missed + 1;
+		int16_t late = (int16_t)(capture - _ref);
+		if (abs(late) < abs(error))
+		{
+			error = late;
+			periods = _missed;
+		}
+		if (periods == 0)
+		{
+			return true; // Same beacon again
+		}
+
+		_driftPpm += (int32_t)error * 1000000L / ((int32_t)periods * _periodTicks) / (1 << TDMA_DRIFT_SHIFT);
+		_driftPpm = max(min(_driftPpm, (int32_t)TDMA_DRIFT_MAX_PPM), (int32_t)-TDMA_DRIFT_MAX_PPM);
+		_stats.OFFSET_US = (int32_t)error * (int32_t)TDMA_TICK_US;
+		_stats.OFFSET_MAX_US = max(_stats.OFFSET_MAX_US, (uint32_t)abs(_stats.OFFSET_US));
+	}
+
+	_slots = slots;
+	_slotTicks = slotTicks;
+	_periodTicks = slotTicks * (slots + 1);
+	_ref = capture;
+	_missed = 0;
+	_state = TDMA_SYNCED;
+	_stats.BEACONS++;
+	return true;
+}
+
+// Beacons, slot TX and radio power. Returns the microseconds until the next slot edge minus TDMA_WAKE_US: the MCU
+// may sleep that long (radio interrupts aside). 0: call again soon.
+uint32_t CC1200Tdma::Service(void)
+{
+	if (_state == TDMA_OFF)
+	{
+		return 0;
+	}
+	if (_mode == TDMA_SLEEP)
+	{
+		// Any SPI access wakes the radio
+		_mode = TDMA_IDLE;
+		_wakeAt = micros();
+	}
+	if (_state == TDMA_SEARCH)
+	{
+		_radio_mode(TDMA_RX);
+		return 0;
+	}
+
+	uint16_t period = _scale(_periodTicks);
+	uint16_t guard = _guard();
+	uint16_t t = _wor_now() - _ref;
+
+	if (_coordinator)
+	{
+		if (t > 0xFFFF - 2 * _leadTicks)
+		{
+			t = 0; // Beacon on its way to the sync word
+		}
+		else if (t + TDMA_WAKE_TICKS >= (uint16_t)(period - _leadTicks))
+		{
+			_send_beacon();
+			return 0;
+		}
+	}
+	else
+	{
+		// Beacon window: the predicted sync word +- guard, then the rest of the beacon
+		while (t >= period + guard + _beaconTicks + TDMA_GUARD_TICKS)
+		{
+			_stats.MISSED++;
+			if (++_missed > TDMA_MAX_MISSED)
+			{
+				_state = TDMA_SEARCH;
+				_stats.RESYNCS++;
+				_radio_mode(TDMA_RX);
+				return 0;
+			}
+			_ref += period;
+			t -= period;
+			guard = _guard();
+		}
+		if (t + guard >= period)
+		{
+			_radio_mode(TDMA_RX);
+			return _sleep_hint(period + guard + _beaconTicks + TDMA_GUARD_TICKS - t);
+		}
+	}
+
+	uint16_t slotTicks = _scale(_slotTicks);
+	uint8_t slot = min(t / slotTicks, _slots + 1);
+	uint16_t start = slot * slotTicks;
+	uint16_t end = start + slotTicks;
+	uint8_t role = (slot >= 1 && slot <= _slots) ? _ROLES[slot] : TDMA_SLEEP;
+
+	if (role == TDMA_TX)
+	{
+		uint16_t mark = _ref + start;
+		if (_txFrame != NULL && !(_slotMarked && _slotMark == mark))
+		{
+			uint16_t at = start + TDMA_GUARD_TICKS;
+			if (t + TDMA_WAKE_TICKS < at)
+			{
+				_radio_mode((uint16_t)(at - t) > 2 * TDMA_WAKE_TICKS ? TDMA_SLEEP : TDMA_IDLE);
+				return _sleep_hint(at - t);
+			}
+
+			_slotMark = mark;
+			_slotMarked = true;
+			if (_missed > 1 || t > at + TDMA_GUARD_TICKS)
+			{
+				_stats.TX_SKIPPED++; // Timing too uncertain or slot start passed: next superframe
+			}
+			else
+			{
+				_radio.WriteTxFifo(_txFrame, _txFrame[0]);
+				_wait_until(_ref + at);
+				_radio.Transmit();
+				_mode = TDMA_TX;
+				_txFrame = NULL;
+				_stats.TX_FRAMES++;
+				return 0;
+			}
+		}
+		role = TDMA_SLEEP;
+	}
+
+	// Listen ahead of an RX slot for the sender's timing error
+	if (role != TDMA_RX && slot < _slots && _ROLES[slot + 1] == TDMA_RX && t + guard >= end)
+	{
+		role = TDMA_RX;
+	}
+	uint16_t next = _next_event(slot, slotTicks, period, guard);
+	if (role == TDMA_RX)
+	{
+		next = min(next, end);
+	}
+	uint16_t wait = (next > t) ? next - t : 0;
+	if (role != TDMA_RX)
+	{
+		role = (wait > 2 * TDMA_WAKE_TICKS) ? TDMA_SLEEP : TDMA_IDLE;
+	}
+	if (!_radio_mode(role))
+	{
+		return 0; // Frame on air
+	}
+	return _sleep_hint(wait);
+}
+
+// TDMA_OFF, TDMA_SEARCH or TDMA_SYNCED
+uint8_t CC1200Tdma::GetState(void)
+{
+	return _state;
+}
+
+// Statistics since Begin*() or the last reset. reset = TRUE clears the counters after reading.
+tdmaStats_t CC1200Tdma::GetStats(bool reset)
+{
+	uint32_t now = micros();
+	tdmaStats_t stats = _stats;
+	stats.DRIFT_PPM = _driftPpm;
+	stats.ELAPSED_US = now - _statsAt;
+	if (_state != TDMA_OFF && _mode != TDMA_SLEEP)
+	{
+		stats.RADIO_ON_US += now - _wakeAt;
+	}
+	if (reset)
+	{
+		memset(&_stats, 0, sizeof(_stats));
+		_statsAt = now;
+		_wakeAt = now;
+	}
+	return stats;
+}
+
+/* Private Helpers */
+
+// Common start: WOR timer at full resolution, RX after every packet, lead and beacon times of the PHY
+void CC1200Tdma::_begin(void)
+{
+	End();
+
+	byte value;
+	_radio.ReadRegister(CC120X_WOR_CFG0, &value, 1);
+	value = (value & ~0x07) | (2 << 1); // RC_MODE [2:1] = calibrate, RC_PD [0] = on
+	_radio.WriteRegister(CC120X_WOR_CFG0, &value, 1);
+	_radio.ReadRegister(CC120X_WOR_CFG1, &value, 1);
+	value &= 0x3F; // WOR_RES [7:6] = 0
+	_radio.WriteRegister(CC120X_WOR_CFG1, &value, 1);
+	_radio.ReadRegister(CC120X_RFEND_CFG1, &value, 1);
+	value |= 0x30; // RXOFF_MODE [5:4] = RX
+	_radio.WriteRegister(CC120X_RFEND_CFG1, &value, 1);
+
+	uint32_t syncUs = _radio.SyncTimeUs();
+	_leadTicks = (TDMA_TX_START_US + syncUs) / TDMA_TICK_US;
+	_beaconTicks = (_radio.AirTimeUs(TDMA_BEACON_LEN + 1) - syncUs) / TDMA_TICK_US + 1;
+
+	memset(_ROLES, TDMA_SLEEP, sizeof(_ROLES));
+	_missed = 0;
+	_driftPpm = 0;
+	_txFrame = NULL;
+	_slotMarked = false;
+	_mode = TDMA_IDLE;
+	_wakeAt = _statsAt = micros();
+	memset(&_stats, 0, sizeof(_stats));
+}
+
+// Superframe, beacon window and drift margin inside the 16-bit WOR timer
+bool CC1200Tdma::_fits(uint32_t periodTicks)
+{
+	uint32_t margin = periodTicks / 128 + 2 * _leadTicks + _beaconTicks + (TDMA_MAX_MISSED + 2) * TDMA_GUARD_TICKS;
+	return (periodTicks <= TDMA_PERIOD_MAX_US / TDMA_TICK_US && periodTicks + margin <= 0xFFFF);
+}
+
+// WOR_TIME1/0. The two bytes are read in one burst while the timer runs: read again until two values agree.
+uint16_t CC1200Tdma::_wor_now(void)
+{
+	byte value[2];
+	uint16_t last = 0;
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		_radio.ReadRegister(CC120X_WOR_TIME1, value, 2);
+		uint16_t now = (value[0] << 8) | value[1];
+		if (i > 0 && (uint16_t)(now - last) <= 1)
+		{
+			return now;
+		}
+		last = now;
+	}
+	return last;
+}
+
+// Poll the timer until tick at (at most TDMA_WAKE_US ahead). Returns the time read.
+uint16_t CC1200Tdma::_wait_until(uint16_t at)
+{
+	uint16_t now;
+	while ((int16_t)((now = _wor_now()) - at) < 0)
+	{
+	}
+	return now;
+}
+
+// Coordinator ticks to own ticks
+uint16_t CC1200Tdma::_scale(uint32_t ticks)
+{
+	return ticks + (int32_t)ticks * _driftPpm / 1000000L;
+}
+
+// Listen margin: grows with every beacon missed
+uint16_t CC1200Tdma::_guard(void)
+{
+	return TDMA_GUARD_TICKS * (_missed + 1);
+}
+
+// Superframe time of the next slot edge that needs the radio after slot
+uint16_t CC1200Tdma::_next_event(uint8_t slot, uint16_t slotTicks, uint16_t periodTicks, uint16_t guard)
+{
+	for (uint8_t i = slot + 1; i <= _slots; i++)
+	{
+		if (_ROLES[i] == TDMA_RX)
+		{
+			return i * slotTicks - guard;
+		}
+		if (_ROLES[i] == TDMA_TX && _txFrame != NULL)
+		{
+			return i * slotTicks + TDMA_GUARD_TICKS;
+		}
+	}
+	return _coordinator ? periodTicks - _leadTicks : periodTicks - guard;
+}
+
+// Bring the radio to TDMA_SLEEP/IDLE/RX. FALSE while a frame is on air or waiting in the RX FIFO.
+bool CC1200Tdma::_radio_mode(uint8_t mode)
+{
+	if (mode == _mode)
+	{
+		return true;
+	}
+	if (_mode == TDMA_TX)
+	{
+		byte state = _radio.GetStat(StatType::MARC_STATE, 0x1F);
+		if (state == MARC_STATE_TX_FIFO_ERR)
+		{
+			_radio.ResolveFifoErr();
+		}
+		else if (state != MARC_STATE_IDLE && state != MARC_STATE_RX)
+		{
+			return false; // Settling, TX (TXOFF_MODE: IDLE or RX)
+		}
+	}
+	else if (_mode == TDMA_RX)
+	{
+		byte rxBytes;
+		_radio.ReadRegister(CC120X_NUM_RXBYTES, &rxBytes, 1);
+		if (rxBytes > 0)
+		{
+			return false;
+		}
+	}
+
+	switch (mode)
+	{
+	case TDMA_SLEEP:
+		_radio.Idle();
+		_radio.PowerDown();
+		_stats.RADIO_ON_US += micros() - _wakeAt;
+		break;
+	case TDMA_IDLE:
+		_radio.Idle();
+		break;
+	case TDMA_RX:
+		_radio.Receive();
+		break;
+	}
+	_mode = mode;
+	return true;
+}
+
+// Beacon [Length Broadcast Source TDMA_BEACON Sequence Slots SlotTicks(2)], sync word on air at the superframe
+// start. Far behind (MCU late) the schedule restarts from this beacon.
+void CC1200Tdma::_send_beacon(void)
+{
+	uint16_t due = _ref + _periodTicks - _leadTicks;
+	byte beacon[TDMA_BEACON_LEN + 1] = { TDMA_BEACON_LEN, BROADCAST_ADDRESS000, _radio.GetAddress(), TDMA_BEACON,
+		_sequence++, _slots, highByte(_slotTicks), lowByte(_slotTicks) };
+	_radio.WriteTxFifo(beacon, TDMA_BEACON_LEN);
+	uint16_t now = _wait_until(due);
+	_radio.Transmit();
+
+	_ref = ((uint16_t)(now - due) > TDMA_GUARD_TICKS) ? now + _leadTicks : _ref + _periodTicks;
+	_mode = TDMA_TX;
+	_stats.BEACONS++;
+}
+
+// Ticks until the next edge to microseconds, less the radio wake-up time
+uint32_t CC1200Tdma::_sleep_hint(uint16_t ticks)
+{
+	uint32_t us = (uint32_t)ticks * TDMA_TICK_US;
+	return (us > TDMA_WAKE_US) ? us - TDMA_WAKE_US : 0;
+}
@@ -0,0 +1,122 @@
+#ifndef _CC120X_TDMA_H
+#define _CC120X_TDMA_H
+
+/* =====================================================================================================================
+												TDMA SLOT SCHEDULER
+  ===================================================================================================================== */
+// Contention-free access on the chip's sleep timer. A coordinator beacons a superframe of one beacon slot and
+// up to TDMA_MAX_SLOTS slots of equal length. Nodes take the WOR timer value captured at the beacon's sync word
+// (WOR_CAPTURE1/0) as the start of the superframe, so MCU interrupt and service latency do not enter the
+// schedule. The slots are timed with WOR_TIME1/0. Between its slots a node puts the radio to SLEEP, where the
+// timer keeps running. The rate error of the node's RC oscillator against the coordinator's is tracked from
+// beacon to beacon and applied to the schedule. After TDMA_MAX_MISSED beacons in a row, the node listens again
+// until the next beacon. The object belongs to the caller, e.g.
+//
+//   CC1200Tdma tdma(cc1200);
+//   tdma.BeginNode(COORDINATOR);
+//   tdma.SetSlot(3, TDMA_TX);                    // own slot
+//   ...
+//   rxFrame_t *frame = cc1200.PeekFrame();
+//   if (frame) { if (!tdma.Receive(frame)) handle(frame); cc1200.PopFrame(); }
+//   if (reading && tdma.Send(txBuffer)) reading = false;
+//   sleepUs(tdma.Service());                    // MCU may sleep this long
+//
+// Beacon: [Length Broadcast Source TDMA_BEACON Sequence Slots SlotTicks(2)]. One tick = TDMA_TICK_US.
+// The superframe must stay below the 16-bit timer period (TDMA_PERIOD_MAX_US). Uses WOR_CFG0/1 (RC oscillator
+// on, WOR_RES = 0), so it does not combine with sniff mode, and RFEND_CFG1.RXOFF_MODE = RX. Reading the timer wakes
+// the radio: call Service() when the time it returned has passed, not in a tight loop.
+
+#include "CC1200.h"
+
+#define TDMA_TICK_US		(1000000UL / SNIFF_RCOSC_HZ)	// WOR timer tick at WOR_RES = 0
+#define TDMA_MAX_SLOTS		16			// Slots after the beacon slot
+#define TDMA_PERIOD_MAX_US	1600000UL	// Superframe limit: WOR_TIME wraps after 65536 ticks
+#define TDMA_TX_START_US	75			// STX until the preamble is on air (IDLE/RX -> TX, no calibration)
+#define TDMA_WAKE_US		500			// SLEEP until the radio is ready (XOSC start-up with margin)
+#define TDMA_GUARD_US		300			// Slot edge margin for timing error. Widens per beacon missed.
+#define TDMA_MAX_MISSED		4			// Beacons missed in a row before searching again
+#define TDMA_DRIFT_SHIFT	2			// Drift correction weight 1/4 per beacon
+#define TDMA_DRIFT_MAX_PPM	5000		// Drift estimate limit
+#define TDMA_BEACON			0xBE		// Beacon type byte (frame[3])
+#define TDMA_BEACON_LEN		7			// Beacon length byte
+
+// States
+#define TDMA_OFF			0
+#define TDMA_SEARCH			1			// Node: RX until a beacon arrives
+#define TDMA_SYNCED			2			// Following the superframe (always for the coordinator)
+
+// Slot roles (SetSlot). Also the radio modes.
+#define TDMA_SLEEP			0
+#define TDMA_TX				1
+#define TDMA_RX				2
+#define TDMA_IDLE			3			// Radio mode only: awake, waiting for the slot
+
+// TDMA accounting
+typedef struct TdmaStats
+{
+	uint32_t BEACONS;						// Beacons sent (coordinator) or received (node)
+	uint32_t MISSED;						// Beacons not received in their window
+	uint32_t RESYNCS;						// Synchronization lost, searching again
+	uint32_t TX_FRAMES;						// Frames sent in own slots
+	uint32_t TX_SKIPPED;					// Own slots left unused: more than one beacon missed
+	int32_t DRIFT_PPM;						// Node WOR timer rate against the coordinator's
+	int32_t OFFSET_US;						// Last beacon: sync word captured minus predicted
+	uint32_t OFFSET_MAX_US;					// Largest |OFFSET_US|
+	uint32_t RADIO_ON_US;					// Radio out of SLEEP
+	uint32_t ELAPSED_US;					// Time covered by the statistics
+} tdmaStats_t;
+
+class CC1200Tdma
+{
+public:
+	CC1200Tdma(CC1200 &radio);
+	bool BeginCoordinator(uint8_t slots, uint32_t slotUs);
+	void BeginNode(uint8_t coordinator = BROADCAST_ADDRESS000);
+	void End(void);
+	void SetSlot(uint8_t slot, uint8_t role);
+	uint32_t MinSlotUs(uint8_t frameBytes);
+
+	bool Send(byte frame[]);
+	bool TxPending(void);
+	bool Receive(const rxFrame_t *frame);
+	bool Receive(const byte frame[], uint8_t len);
+	uint32_t Service(void);
+	uint8_t GetState(void);
+	tdmaStats_t GetStats(bool reset = false);
+
+private:
+	CC1200 &_radio;
+	uint8_t _state = TDMA_OFF;
+	bool _coordinator;
+	uint8_t _coordinatorAddress;
+	uint8_t _ROLES[TDMA_MAX_SLOTS + 1];		// Slot 0: beacon
+	uint8_t _slots;
+	uint16_t _slotTicks, _periodTicks;		// Coordinator's clock
+	uint16_t _leadTicks;					// STX to sync word on air
+	uint16_t _beaconTicks;					// Sync word to the end of the beacon
+	uint16_t _ref;							// WOR time of the current superframe's beacon sync word
+	uint8_t _missed;
+	int32_t _driftPpm;
+	uint8_t _sequence;
+
+	byte *_txFrame;
+	uint16_t _slotMark;						// Superframe-absolute start of the TX slot last served
+	bool _slotMarked;
+
+	uint8_t _mode;							// Radio mode TDMA_SLEEP/IDLE/RX/TX
+	uint32_t _wakeAt, _statsAt;
+	tdmaStats_t _stats;
+
+	void _begin(void);
+	bool _fits(uint32_t periodTicks);
+	uint16_t _wor_now(void);
+	uint16_t _wait_until(uint16_t at);
+	uint16_t _scale(uint32_t ticks);
+	uint16_t _guard(void);
+	uint16_t _next_event(uint8_t slot, uint16_t slotTicks, uint16_t periodTicks, uint16_t guard);
+	bool _radio_mode(uint8_t mode);
+	void _send_beacon(void);
+	uint32_t _sleep_hint(uint16_t ticks);
+};
+
+#endif // !_CC120X_TDMA_H
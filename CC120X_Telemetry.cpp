@@ -0,0 +1,176 @@
+/*
+
+Copyright (c) 2018 Md Abdullah AL IMRAN | alimran.mdabdullah@gmail.com
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ 1. Redistributions of source code must retain the above copyright
+	notice, this list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright
+	notice, this list of conditions and the following disclaimer in the
+	documentation and/or other materials provided with the distribution.
+ 3. The name of the author may not be used to endorse or promote products
+	derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "CC120X_Telemetry.h"
+
+CC1200Telemetry::CC1200Telemetry(void)
+{
+	Reset();
+}
+
+// Forget all peers
+void CC1200Telemetry::Reset(void)
+{
+	memset(_PEERS, 0, sizeof(_PEERS));
+}
+
+// Book a frame from the received-frame queue. Needs PKT_CFG1.APPEND_STATUS. Returns the peer's entry.
+const peerLink_t *CC1200Telemetry::Update(const rxFrame_t *frame)
+{
+	return _update(frame->SOURCE, RssiDbm((uint8_t)frame->RSSI), frame->LQI, frame->CRC_OK, frame->TIMESTAMP);
+}
+
+// Book a frame as read by ReadRxFifo(): [Length Target Source --Payload-- RSSI CRC_OK|LQI], len bytes.
+// NULL if the frame is too short to carry a source address and the status bytes.
+const peerLink_t *CC1200Telemetry::Update(const byte frame[], uint8_t len)
+{
+	if (len < 5 || frame[0] + 3 != len)
+	{
+		return NULL;
+	}
+	byte status = frame[len - 1];
+	return _update(frame[2], RssiDbm(frame[len - 2]), status & CC120X_LQI_EST_BM, (status & CC120X_LQI_CRC_OK_BM) != 0, micros());
+}
+
+// Statistics of a peer, NULL if not in the table
+const peerLink_t *CC1200Telemetry::GetPeer(uint8_t address)
+{
+	return _find(address);
+}
+
+// Table slot 0 .. TELEMETRY_PEERS - 1 (for listing all peers), NULL if unused
+const peerLink_t *CC1200Telemetry::GetSlot(uint8_t slot)
+{
+	if (slot >= TELEMETRY_PEERS || !_PEERS[slot].USED)
+	{
+		return NULL;
+	}
+	return &_PEERS[slot];
+}
+
+// CRC failures in percent of the frames received from peer
+uint8_t CC1200Telemetry::CrcFailPercent(const peerLink_t *peer)
+{
+	if (peer == NULL || peer->FRAMES == 0)
+	{
+		return 0;
+	}
+	return (uint8_t)((uint32_t)peer->CRC_ERRORS * 100 / peer->FRAMES);
+}
+
+// Appended RSSI byte (two's complement) to dBm
+int8_t CC1200Telemetry::RssiDbm(uint8_t raw)
+{
+	if ((int8_t)raw == TELEMETRY_RSSI_INVALID)
+	{
+		return TELEMETRY_RSSI_INVALID;
+	}
+	return (int8_t)max((int16_t)(int8_t)raw - RSSI_OFFSET, (int16_t)(TELEMETRY_RSSI_INVALID + 1));
+}
+
+// One update: two slots probed, fixed number of operations
+const peerLink_t *CC1200Telemetry::_update(uint8_t source, int8_t rssi, uint8_t lqi, bool crcOk, uint32_t now)
+{
+	peerLink_t *peer = _find(source);
+	if (peer == NULL)
+	{
+		peerLink_t *a = &_PEERS[source & (TELEMETRY_PEERS - 1)];
+		peerLink_t *b = &_PEERS[(source & (TELEMETRY_PEERS - 1)) ^ 1];
+		peer = !a->USED ? a : !b->USED ? b : ((int32_t)(a->LAST_SEEN - b->LAST_SEEN) <= 0 ? a : b);
+		memset(peer, 0, sizeof(peerLink_t));
+		peer->USED = true;
+		peer->ADDRESS = source;
+		peer->RSSI_MIN = 127; // No RSSI yet: MIN > MAX
+		peer->RSSI_MAX = TELEMETRY_RSSI_INVALID;
+	}
+
+	peer->LAST_SEEN = now;
+	if (peer->FRAMES < 0xFFFF)
+	{
+		peer->FRAMES++;
+		if (!crcOk)
+		{
+			peer->CRC_ERRORS++;
+		}
+	}
+	if (rssi == TELEMETRY_RSSI_INVALID)
+	{
+		return peer;
+	}
+
+	if (peer->RSSI_MIN > peer->RSSI_MAX) // First RSSI
+	{
+		peer->RSSI_EMA = rssi * 16;
+		peer->LQI_EMA = lqi * 16;
+		peer->RSSI_MIN = peer->RSSI_MAX = rssi;
+	}
+	else
+	{
+		peer->RSSI_EMA += (rssi * 16 - peer->RSSI_EMA) / (1 << TELEMETRY_EMA_SHIFT);
+		peer->LQI_EMA += ((int16_t)(lqi * 16) - (int16_t)peer->LQI_EMA) / (1 << TELEMETRY_EMA_SHIFT);
+		peer->RSSI_MIN = min(peer->RSSI_MIN, rssi);
+		peer->RSSI_MAX = max(peer->RSSI_MAX, rssi);
+	}
+
+	int16_t bucket = (rssi - TELEMETRY_BUCKET_MIN) / TELEMETRY_BUCKET_DB;
+	if (bucket < 0)
+	{
+		bucket = 0;
+	}
+	else if (bucket >= TELEMETRY_BUCKETS)
+	{
+		bucket = TELEMETRY_BUCKETS - 1;
+	}
+	if (peer->HIST[bucket] == 0xFF)
+	{
+		for (uint8_t i = 0; i < TELEMETRY_BUCKETS; i++)
+		{
+			peer->HIST[i] >>= 1; // Keep the shape, age old samples
+		}
+	}
+	peer->HIST[bucket]++;
+	return peer;
+}
+
+// Slot holding address, NULL if none
+peerLink_t *CC1200Telemetry::_find(uint8_t address)
+{
+	uint8_t slot = address & (TELEMETRY_PEERS - 1);
+	if (_PEERS[slot].USED && _PEERS[slot].ADDRESS == address)
+	{
+		return &_PEERS[slot];
+	}
+	slot ^= 1;
+	if (_PEERS[slot].USED && _PEERS[slot].ADDRESS == address)
+	{
+		return &_PEERS[slot];
+	}
+	return NULL;
+}
@@ -0,0 +1,64 @@
+#ifndef _CC120X_TELEMETRY_H
+#define _CC120X_TELEMETRY_H
+
+/* =====================================================================================================================
+												PER-PEER LINK TELEMETRY
+  ===================================================================================================================== */
+// Decodes the status bytes appended to received frames (PKT_CFG1.APPEND_STATUS: RSSI, CRC_OK | LQI) and keeps
+// link statistics per source address in a fixed table: RSSI in dBm (moving average, min/max, histogram), LQI,
+// frame and CRC error counts. Two-way set-associative: a source maps to two slots, the older one is replaced
+// when both are taken, so every update costs the same. The table belongs to the caller, e.g.
+//
+//   CC1200Telemetry links;
+//   ...
+//   rxFrame_t *frame = cc1200.PeekFrame();
+//   if (frame) { links.Update(frame); cc1200.PopFrame(); }
+//   const peerLink_t *peer = links.GetPeer(7);
+//
+// A frame that failed CRC is booked to its source byte as received, which may itself be corrupt.
+
+#include "CC1200.h"
+
+#define TELEMETRY_PEERS			8		// Table slots (power of 2)
+#define TELEMETRY_BUCKETS		8		// RSSI histogram buckets
+#define TELEMETRY_BUCKET_MIN	-120	// dBm at the bottom of bucket 0. Lower values count in bucket 0.
+#define TELEMETRY_BUCKET_DB		10		// Bucket width. Higher values count in the last bucket.
+#define TELEMETRY_EMA_SHIFT		3		// Moving average weight 1/8
+#define TELEMETRY_RSSI_INVALID	-128	// Appended RSSI when no valid estimate existed
+
+// Link statistics of one peer
+typedef struct PeerLink
+{
+	bool USED;
+	uint8_t ADDRESS;						// Source address
+	int16_t RSSI_EMA;						// Moving average RSSI, dBm x 16
+	int8_t RSSI_MIN, RSSI_MAX;				// dBm
+	uint16_t LQI_EMA;						// Moving average LQI x 16 (lower is better)
+	uint16_t FRAMES;						// Frames received (CRC errors included)
+	uint16_t CRC_ERRORS;					// Frames with CRC_OK cleared
+	uint32_t LAST_SEEN;						// micros() of the last frame
+	uint8_t HIST[TELEMETRY_BUCKETS];		// RSSI histogram. Halved when a bucket would overflow.
+} peerLink_t;
+
+class CC1200Telemetry
+{
+public:
+	CC1200Telemetry(void);
+	void Reset(void);
+
+	const peerLink_t *Update(const rxFrame_t *frame);
+	const peerLink_t *Update(const byte frame[], uint8_t len);
+	const peerLink_t *GetPeer(uint8_t address);
+	const peerLink_t *GetSlot(uint8_t slot);
+	uint8_t CrcFailPercent(const peerLink_t *peer);
+
+	static int8_t RssiDbm(uint8_t raw);
+
+private:
+	peerLink_t _PEERS[TELEMETRY_PEERS];
+
+	const peerLink_t *_update(uint8_t source, int8_t rssi, uint8_t lqi, bool crcOk, uint32_t now);
+	peerLink_t *_find(uint8_t address);
+};
+
+#endif // !_CC120X_TELEMETRY_H
@@ -0,0 +1,264 @@
+#ifndef _CC120X_TRANSPORT_H
+#define _CC120X_TRANSPORT_H
+
+/* =====================================================================================================================
+												SPI TRANSPORT BACKENDS
+  ===================================================================================================================== */
+// CC1200 never touches the SPI peripheral directly. Every transaction goes through CC120X_SPI, a class with
+// static members only, selected at compile time:
+//
+//   AvrSpiTransport  - AVR hardware SPI (SPCR/SPSR/SPDR). Default when __AVR__ is defined.
+//   HostSpiTransport - In-memory bus for host builds. Bytes are exchanged with the HostSpiDevice attached
+//                      to the selected chip-select pin.
+//
+// A custom backend may be used by defining CC1200_TRANSPORT to its class name before including CC1200.h.
+// It must provide: Begin(), End(), Probe(ssPin, misoPin), Select(ssPin, misoPin), Deselect(ssPin), Transfer(data)
+// and Stats, plus
+// the non-blocking primitives used by the transaction engine: INTERRUPTS, Start(data), Received(),
+// EnableInterrupt(), DisableInterrupt(), EnterCritical() and ExitCritical(state). A backend without a
+// transfer-complete interrupt (INTERRUPTS = false) has its queued transactions run to completion on submit.
+
+// Per-bus transfer accounting
+typedef struct SpiStats
+{
+	uint32_t BYTES;			// Bytes shifted on the bus
+	uint32_t CS_TOGGLES;	// Chip-select assertions (i.e. transactions)
+#if defined(CC1200_INSTRUMENT)
+	uint32_t WAIT_SPINS;	// Polls of the transfer-complete flag
+	uint32_t READY_SPINS;	// Polls of CHIP_RDYn (MISO) after chip select
+#endif
+} spiStats_t;
+
+
+#if defined(__AVR__)
+#if defined(CC1200_INSTRUMENT)
+#define wait_spi()  while(!(SPSR & _BV(SPIF))) Stats.WAIT_SPINS++	// Wait until SPI operation is terminated
+#define wait_ready(pin)  while (digitalRead(pin)) Stats.READY_SPINS++
+#else
+#define wait_spi()  while(!(SPSR & _BV(SPIF)))		// Wait until SPI operation is terminated
+#define wait_ready(pin)  while (digitalRead(pin))
+#endif
+
+/******************************************************************************
+* AVR HARDWARE SPI
+*/
+class AvrSpiTransport
+{
+public:
+	static spiStats_t Stats;
+
+	// SPI Enable as Master with speed = clk/4, mode 0, MSB first
+	static inline void Begin(void)
+	{
+		/*
+		Spi prescaler:
+			SPI2X SPR1 SPR0
+				0     0     0    fosc/4
+				0     0     1    fosc/16
+				0     1     0    fosc/64
+				0     1     1    fosc/128
+				1     0     0    fosc/2
+				1     0     1    fosc/8
+				1     1     0    fosc/32
+				1     1     1    fosc/64
+		*/
+		byte dummy;
+		SPCR = 0;								// Reset to defaults
+		SPCR = _BV(SPE) | _BV(MSTR);			// SPI Enable as Master with speed = clk/4
+		dummy = SPCR;
+		dummy = SPDR;
+		(void)dummy;
+	}
+
+	static inline void End(void)
+	{
+		SPCR = 0;
+	}
+
+	// Sample CHIP_RDYn (MISO) with SS LOW, without waiting. SS LOW also wakes the chip from SLEEP/XOFF.
+	static inline bool Probe(uint8_t ssPin, uint8_t misoPin)
+	{
+		digitalWrite(ssPin, LOW);
+		bool ready = !digitalRead(misoPin);
+		digitalWrite(ssPin, HIGH);
+		return ready;
+	}
+
+	// Pull the SS pin LOW and wait until the chip is ready (MISO LOW)
+	static inline void Select(uint8_t ssPin, uint8_t misoPin)
+	{
+		digitalWrite(ssPin, LOW);
+		wait_ready(misoPin);
+		Stats.CS_TOGGLES++;
+	}
+
+	// Pull the SS pin HIGH - Inactive
+	static inline void Deselect(uint8_t ssPin)
+	{
+		digitalWrite(ssPin, HIGH);
+	}
+
+	// Single Byte Read/Write
+	static inline uint8_t Transfer(uint8_t data)
+	{
+		SPDR = data;
+		wait_spi();
+		Stats.BYTES++;
+		return SPDR;
+	}
+
+	/* Non-blocking (SPI_STC_vect fires when the byte is shifted) */
+	static const bool INTERRUPTS = true;
+
+	static inline void Start(uint8_t data)
+	{
+		SPDR = data;
+		Stats.BYTES++;
+	}
+
+	static inline uint8_t Received(void)
+	{
+		return SPDR;
+	}
+
+	static inline void EnableInterrupt(void)
+	{
+		SPCR |= _BV(SPIE);
+	}
+
+	static inline void DisableInterrupt(void)
+	{
+		SPCR &= ~_BV(SPIE);
+	}
+
+	static inline uint8_t EnterCritical(void)
+	{
+		uint8_t sreg = SREG;
+		cli();
+		return sreg;
+	}
+
+	static inline void ExitCritical(uint8_t state)
+	{
+		SREG = state;
+	}
+};
+#endif // __AVR__
+
+
+#if !defined(ARDUINO)
+/******************************************************************************
+* HOST IN-MEMORY SPI
+*/
+// Device model sitting behind the host bus (e.g. a chip simulator or a scripted responder).
+class HostSpiDevice
+{
+public:
+	virtual ~HostSpiDevice() {}
+	virtual void Select(void) = 0;					// CS asserted
+	virtual uint8_t Exchange(uint8_t mosi) = 0;		// One full-duplex byte. Returns MISO.
+	virtual void Deselect(void) = 0;				// CS released
+	virtual bool Ready(void) { return true; }		// CHIP_RDYn LOW, sampled with CS asserted
+};
+
+class HostSpiTransport
+{
+public:
+	static spiStats_t Stats;
+	static uint16_t BYTE_TIME_NS;	// Simulated time per byte. Default 2000 ns (4 MHz SCLK).
+
+	// Put a device behind the chip-select pin ssPin (up to 4 devices)
+	static void Attach(HostSpiDevice *device, uint8_t ssPin = SS)
+	{
+		for (uint8_t i = 0; i < 4; i++)
+		{
+			if (_DEVICE[i] == device || _DEVICE[i] == NULL || _DEVICE_SS[i] == ssPin)
+			{
+				_DEVICE[i] = device;
+				_DEVICE_SS[i] = ssPin;
+				return;
+			}
+		}
+	}
+
+	static inline void Begin(void) {}
+	static inline void End(void) {}
+
+	// A probe takes about 1 us (two pin toggles)
+	static inline bool Probe(uint8_t ssPin, uint8_t misoPin)
+	{
+		(void)misoPin;
+		host_advance(1);
+		for (uint8_t i = 0; i < 4; i++)
+		{
+			if (_DEVICE[i] && _DEVICE_SS[i] == ssPin) return _DEVICE[i]->Ready();
+		}
+		return true;
+	}
+
+	static inline void Select(uint8_t ssPin, uint8_t misoPin)
+	{
+		(void)misoPin;
+		digitalWrite(ssPin, LOW);
+		Stats.CS_TOGGLES++;
+		_SELECTED = NULL;
+		for (uint8_t i = 0; i < 4; i++)
+		{
+			if (_DEVICE[i] && _DEVICE_SS[i] == ssPin) _SELECTED = _DEVICE[i];
+		}
+		if (_SELECTED) _SELECTED->Select();
+	}
+
+	static inline void Deselect(uint8_t ssPin)
+	{
+		if (_SELECTED) _SELECTED->Deselect();
+		_SELECTED = NULL;
+		digitalWrite(ssPin, HIGH);
+	}
+
+	// No device selected: behaves as an idle, ready chip (status byte 0x00)
+	static inline uint8_t Transfer(uint8_t data)
+	{
+		Stats.BYTES++;
+		_busNs += BYTE_TIME_NS;
+		if (_busNs >= 1000)
+		{
+			host_advance(_busNs / 1000);
+			_busNs %= 1000;
+		}
+		return _SELECTED ? _SELECTED->Exchange(data) : 0x00;
+	}
+
+	/* Non-blocking: no interrupt, the byte is shifted at once */
+	static const bool INTERRUPTS = false;
+
+	static inline void Start(uint8_t data) { _LATCH = Transfer(data); }
+	static inline uint8_t Received(void) { return _LATCH; }
+	static inline void EnableInterrupt(void) {}
+	static inline void DisableInterrupt(void) {}
+	static inline uint8_t EnterCritical(void) { return 0; }
+	static inline void ExitCritical(uint8_t state) { (void)state; }
+
+private:
+	static HostSpiDevice *_DEVICE[4];
+	static uint8_t _DEVICE_SS[4];
+	static HostSpiDevice *_SELECTED;
+	static uint8_t _LATCH;			// Byte received by Start()
+	static uint16_t _busNs;			// Sub-microsecond remainder of bus time
+};
+#endif // !ARDUINO
+
+
+#if !defined(CC1200_TRANSPORT)
+	#if defined(__AVR__)
+		#define CC1200_TRANSPORT AvrSpiTransport
+	#elif !defined(ARDUINO)
+		#define CC1200_TRANSPORT HostSpiTransport
+	#else
+		#error "CC1200: no SPI transport for this architecture. Define CC1200_TRANSPORT."
+	#endif
+#endif
+
+typedef CC1200_TRANSPORT CC120X_SPI;
+
+#endif // !_CC120X_TRANSPORT_H
@@ -0,0 +1,140 @@
+#include"CC1200.h"				// TI CC1200 RF Radio
+
+// AES-128 benchmark: on-chip engine (AES_KEY / AES_BUFFER / AES) against software AES on this MCU.
+// Reports microseconds per 16-byte block and per 64-byte CTR payload, and checks that both agree.
+// Key and block are the FIPS-197 example (cipher text 69c4e0d86a7b0430d8cdb78070b4c55a).
+
+#define ITERATIONS		100		// Blocks per measurement
+#define PAYLOAD_LEN		64		// CTR payload
+
+const byte key[AES_BLOCK_SIZE] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F };
+const byte plain[AES_BLOCK_SIZE] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF };
+
+byte payload[PAYLOAD_LEN];
+
+// AES S-box (FIPS-197)
+const byte sbox[256] PROGMEM = {
+	0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F, 0xC5, 0x30, 0x01, 0x67, 0x2B, 0xFE, 0xD7, 0xAB, 0x76,
+	0xCA, 0x82, 0xC9, 0x7D, 0xFA, 0x59, 0x47, 0xF0, 0xAD, 0xD4, 0xA2, 0xAF, 0x9C, 0xA4, 0x72, 0xC0,
+	0xB7, 0xFD, 0x93, 0x26, 0x36, 0x3F, 0xF7, 0xCC, 0x34, 0xA5, 0xE5, 0xF1, 0x71, 0xD8, 0x31, 0x15,
+	0x04, 0xC7, 0x23, 0xC3, 0x18, 0x96, 0x05, 0x9A, 0x07, 0x12, 0x80, 0xE2, 0xEB, 0x27, 0xB2, 0x75,
+	0x09, 0x83, 0x2C, 0x1A, 0x1B, 0x6E, 0x5A, 0xA0, 0x52, 0x3B, 0xD6, 0xB3, 0x29, 0xE3, 0x2F, 0x84,
+	0x53, 0xD1, 0x00, 0xED, 0x20, 0xFC, 0xB1, 0x5B, 0x6A, 0xCB, 0xBE, 0x39, 0x4A, 0x4C, 0x58, 0xCF,
+	0xD0, 0xEF, 0xAA, 0xFB, 0x43, 0x4D, 0x33, 0x85, 0x45, 0xF9, 0x02, 0x7F, 0x50, 0x3C, 0x9F, 0xA8,
+	0x51, 0xA3, 0x40, 0x8F, 0x92, 0x9D, 0x38, 0xF5, 0xBC, 0xB6, 0xDA, 0x21, 0x10, 0xFF, 0xF3, 0xD2,
+	0xCD, 0x0C, 0x13, 0xEC, 0x5F, 0x97, 0x44, 0x17, 0xC4, 0xA7, 0x7E, 0x3D, 0x64, 0x5D, 0x19, 0x73,
+	0x60, 0x81, 0x4F, 0xDC, 0x22, 0x2A, 0x90, 0x88, 0x46, 0xEE, 0xB8, 0x14, 0xDE, 0x5E, 0x0B, 0xDB,
+	0xE0, 0x32, 0x3A, 0x0A, 0x49, 0x06, 0x24, 0x5C, 0xC2, 0xD3, 0xAC, 0x62, 0x91, 0x95, 0xE4, 0x79,
+	0xE7, 0xC8, 0x37, 0x6D, 0x8D, 0xD5, 0x4E, 0xA9, 0x6C, 0x56, 0xF4, 0xEA, 0x65, 0x7A, 0xAE, 0x08,
+	0xBA, 0x78, 0x25, 0x2E, 0x1C, 0xA6, 0xB4, 0xC6, 0xE8, 0xDD, 0x74, 0x1F, 0x4B, 0xBD, 0x8B, 0x8A,
+	0x70, 0x3E, 0xB5, 0x66, 0x48, 0x03, 0xF6, 0x0E, 0x61, 0x35, 0x57, 0xB9, 0x86, 0xC1, 0x1D, 0x9E,
+	0xE1, 0xF8, 0x98, 0x11, 0x69, 0xD9, 0x8E, 0x94, 0x9B, 0x1E, 0x87, 0xE9, 0xCE, 0x55, 0x28, 0xDF,
+	0x8C, 0xA1, 0x89, 0x0D, 0xBF, 0xE6, 0x42, 0x68, 0x41, 0x99, 0x2D, 0x0F, 0xB0, 0x54, 0xBB, 0x16
+};
+
+// Software AES-128 encryption of one block in place, round keys expanded on the fly
+void softAesEncrypt(const byte aesKey[], byte block[])
+{
+	byte k[16], t[16], rcon = 0x01;
+	memcpy(k, aesKey, 16);
+	for (byte i = 0; i < 16; i++) block[i] ^= k[i];
+
+	for (byte round = 1; round <= 10; round++)
+	{
+		for (byte c = 0; c < 4; c++)				// SubBytes + ShiftRows
+		{
+			for (byte r = 0; r < 4; r++) t[4 * c + r] = pgm_read_byte(&sbox[block[4 * ((c + r) & 3) + r]]);
+		}
+		for (byte c = 0; c < 4; c++)				// MixColumns (not in the last round)
+		{
+			byte *col = &t[4 * c];
+			byte all = col[0] ^ col[1] ^ col[2] ^ col[3], first = col[0];
+			for (byte r = 0; r < 4; r++)
+			{
+				byte x = col[r] ^ (r < 3 ? col[r + 1] : first);
+				x = (x << 1) ^ ((x & 0x80) ? 0x1B : 0x00);
+				block[4 * c + r] = (round < 10) ? (col[r] ^ all ^ x) : col[r];
+			}
+		}
+		k[0] ^= pgm_read_byte(&sbox[k[13]]) ^ rcon;	// Next round key
+		k[1] ^= pgm_read_byte(&sbox[k[14]]);
+		k[2] ^= pgm_read_byte(&sbox[k[15]]);
+		k[3] ^= pgm_read_byte(&sbox[k[12]]);
+		for (byte i = 4; i < 16; i++) k[i] ^= k[i - 4];
+		rcon = (rcon << 1) ^ ((rcon & 0x80) ? 0x1B : 0x00);
+		for (byte i = 0; i < 16; i++) block[i] ^= k[i];
+	}
+}
+
+// Software CTR (same counter handling as AesCtr)
+void softAesCtr(byte counter[], byte data[], uint16_t len)
+{
+	byte stream[AES_BLOCK_SIZE];
+	for (uint16_t pos = 0; pos < len; pos += AES_BLOCK_SIZE)
+	{
+		memcpy(stream, counter, AES_BLOCK_SIZE);
+		softAesEncrypt(key, stream);
+		for (int8_t i = AES_BLOCK_SIZE - 1; i >= 0 && ++counter[i] == 0; i--);
+		for (byte i = 0; i < AES_BLOCK_SIZE && pos + i < len; i++) data[pos + i] ^= stream[i];
+	}
+}
+
+// Print one benchmark row
+void report(const char *name, uint16_t calls, unsigned long elapsed)
+{
+	Serial.print(name); Serial.print(F("\t"));
+	Serial.println(elapsed / calls);
+}
+
+void setup(){
+	Serial.begin(115200);
+	Serial.println(F("\n>>CC1200 AES Benchmark"));
+
+	cc1200.Init(SS, MOSI, MISO, SCK, PIN_UNUSED);
+	cc1200.Idle();
+	cc1200.AesSetKey(key);
+
+	byte chip[AES_BLOCK_SIZE], soft[AES_BLOCK_SIZE];
+	unsigned long start;
+	Serial.println(F("Operation\t\tus"));
+
+	// One block
+	start = micros();
+	for (int i = 0; i < ITERATIONS; i++)
+	{
+		memcpy(chip, plain, AES_BLOCK_SIZE);
+		cc1200.AesEncrypt(chip);
+	}
+	report("Chip block\t", ITERATIONS, micros() - start);
+
+	start = micros();
+	for (int i = 0; i < ITERATIONS; i++)
+	{
+		memcpy(soft, plain, AES_BLOCK_SIZE);
+		softAesEncrypt(key, soft);
+	}
+	report("Software block\t", ITERATIONS, micros() - start);
+	Serial.println(memcmp(chip, soft, AES_BLOCK_SIZE) ? F("Block MISMATCH") : F("Block OK"));
+
+	// CTR payload (the chip encrypts the next counter block while the current one is applied)
+	byte counter[AES_BLOCK_SIZE];
+	for (int i = 0; i < PAYLOAD_LEN; i++) payload[i] = i;
+	memset(counter, 0, sizeof(counter));
+	start = micros();
+	cc1200.AesCtr(counter, payload, PAYLOAD_LEN);
+	report("Chip CTR 64B\t", 1, micros() - start);
+
+	memset(counter, 0, sizeof(counter));
+	start = micros();
+	softAesCtr(counter, payload, PAYLOAD_LEN);	// Decrypts the chip's cipher text
+	report("Software CTR 64B", 1, micros() - start);
+
+	bool ok = true;
+	for (int i = 0; i < PAYLOAD_LEN; i++) ok &= (payload[i] == i);
+	Serial.println(ok ? F("CTR OK") : F("CTR MISMATCH"));
+
+	Serial.println(F("Done."));
+}
+
+void loop(){
+}
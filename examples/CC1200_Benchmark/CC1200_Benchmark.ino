@@ -0,0 +1,73 @@
+#include"CC1200.h"				// TI CC1200 RF Radio
+
+// Per-transaction SPI benchmark of the hot API paths.
+// Reports per call: SPI bytes, CS toggles, elapsed bus time (us) and throughput (bytes/s).
+// Compare the printed table between library revisions to catch regressions.
+
+#define ITERATIONS		100		// Calls per measured API (Configure runs once)
+#define PAYLOAD_LEN		60		// Bytes written per WriteTxFifo call
+
+byte txBuffer[PAYLOAD_LEN + 1];
+byte rxBuffer[128];
+
+// Print one benchmark row
+void report(const char *name, uint16_t calls, unsigned long elapsed, spiStats_t stats)
+{
+	Serial.print(name); Serial.print(F("\t"));
+	Serial.print(stats.BYTES / calls); Serial.print(F("\t"));
+	Serial.print(stats.CS_TOGGLES / calls); Serial.print(F("\t"));
+	Serial.print(elapsed / calls); Serial.print(F("\t"));
+	Serial.println(elapsed ? (unsigned long)(stats.BYTES * 1000000.0 / elapsed) : 0);
+}
+
+void setup(){
+	Serial.begin(115200);
+	Serial.println(F("\n>>CC1200 SPI Benchmark"));
+
+	cc1200.Init(SS, MOSI, MISO, SCK, PIN_UNUSED);
+	cc1200.Idle();
+
+	txBuffer[0] = PAYLOAD_LEN - 1;
+	for (int i = 1; i <= PAYLOAD_LEN; i++)
+	{
+		txBuffer[i] = i;
+	}
+
+	Serial.println(F("API\t\tBytes\tCS\tus\tBytes/s"));
+	unsigned long start;
+	cc1200.GetSpiStats(true);
+
+	// Configure
+	start = micros();
+	cc1200.Configure(preferredSettings, prefSettLen);
+	report("Configure", 1, micros() - start, cc1200.GetSpiStats(true));
+
+	// GetStat (status byte)
+	start = micros();
+	for (int i = 0; i < ITERATIONS; i++) cc1200.GetStat(StatType::STATUS);
+	report("GetStat(STATUS)", ITERATIONS, micros() - start, cc1200.GetSpiStats(true));
+
+	// GetStat (extended register)
+	start = micros();
+	for (int i = 0; i < ITERATIONS; i++) cc1200.GetStat(StatType::MARC_STATE, 0x1F);
+	report("GetStat(MARC)", ITERATIONS, micros() - start, cc1200.GetSpiStats(true));
+
+	// WriteTxFifo
+	start = micros();
+	for (int i = 0; i < ITERATIONS; i++)
+	{
+		cc1200.WriteTxFifo(txBuffer, PAYLOAD_LEN - 1);
+		cc1200.FlushTxFifo();
+	}
+	report("WriteTxFifo", ITERATIONS, micros() - start, cc1200.GetSpiStats(true));
+
+	// ReadRxFifo
+	start = micros();
+	for (int i = 0; i < ITERATIONS; i++) cc1200.ReadRxFifo(rxBuffer);
+	report("ReadRxFifo", ITERATIONS, micros() - start, cc1200.GetSpiStats(true));
+
+	Serial.println(F("Done."));
+}
+
+void loop(){
+}
@@ -170,9 +170,9 @@ void setup(){
 
 	// CC1200 RADIO
 	cc1200.Init(SS, MOSI, MISO, SCK, PIN_UNUSED); // SS, MOSI, MISO, SCK, RadioResetpin
-	cc1200.Configure(preferredSettings, prefSettLen); // 2sec internal delay
+	cc1200.Configure(preferredSettings, prefSettLen);
 	cc1200.SetAddress(THIS_NODE); delay(10);
-	cc1200.Strobe(CC120X_SCAL); delay(1000);
+	cc1200.Strobe(CC120X_SCAL); cc1200.WaitState(MARC_STATE_IDLE);
 	byte readNode = cc1200.GetAddress(false);
 	Serial.print("\tNode: "); Serial.println(readNode);
 	if (THIS_NODE == readNode)
@@ -0,0 +1,760 @@
+#include "CC1200.h"				// TI CC1200 RF Radio
+#include "CC120X_Sim.h"			// Chip simulator (host)
+#include "CC120X_Arq.h"			// Reliable delivery
+#include "CC120X_Aggregate.h"		// Message aggregation
+
+#include <stdio.h>
+#include <string.h>
+
+// Host benchmark suite: the unmodified driver against the chip simulator on the virtual clock.
+// Sweeps packet length, symbol rate, register access (single/burst/cached), completion by status polling
+// against interrupt, configuration table size, full against delta PHY profile switching, continuous CFM
+// streaming by sample rate, ARQ bulk transfer by window size over a lossy link and small messages one per frame
+// against aggregated. Reports per case packets (operations)/s, payload bytes/s,
+// SPI bytes per payload byte and per operation, CS toggles and latency percentiles (simulated us).
+//
+// Build and run from the library root (the Arduino IDE ignores extras/):
+//   g++ -std=gnu++11 -O2 -I. -o hostbench extras/HostBenchmark/HostBenchmark.cpp *.cpp
+//   ./hostbench            table
+//   ./hostbench --json     one JSON object per case (JSON Lines)
+// Time is simulated, so the output is deterministic: keep the --json output of a known good revision and
+// diff it against a new run to see regressions in CC1200.cpp before they ship.
+
+#define RADIO_OPS		16			// Packets per radio case
+#define REGISTER_OPS	64			// Calls per register/configuration case
+#define CFM_OPS			1024		// Samples per CFM streaming case
+#define CFM_HALF		64			// CFM double buffer half (samples)
+#define WAIT_US			2000000UL	// Give up on a packet after this long
+#define FIFO_MAX_LEN	125			// Largest length byte through the FIFO paths (frame + 2 status bytes fit)
+#define RX_SETTLE_US	1000		// StartReceive() until the radio listens (calibration included)
+#define IRQ_PIN			2			// Host pin driven by GPIO2 (PKT_SYNC_RXTX)
+#define ARQ_OPS			64			// Messages per ARQ case
+#define ARQ_LOOP_US		50			// Main loop period of the ARQ cases
+#define PEER_SS			10			// Second radio (ARQ receiver)
+#define PEER_IRQ_PIN	3
+#define AGG_OPS			64			// Messages per aggregation case
+
+const uint16_t LENGTHS[] = { 3, 16, 64, 125, 192, 255 };	// Length byte [Length Target Source --Payload--]
+const uint8_t RATE_EXPONENTS[] = { 5, 7, 9, 11 };			// SYMBOL_RATE2.SRATE_E: 4.8, 19.2, 76.8, 307.2 ksps
+const uint8_t TABLE_SIZES[] = { 8, 16, 32, prefSettLen };
+const uint32_t SAMPLE_RATES[] = { 8000, 48000, 96000, 192000 };	// CFM samples per second
+const uint8_t ARQ_WINDOWS[] = { 1, 2, 4, 8 };
+const uint8_t MESSAGE_SIZES[] = { 4, 8, 16 };
+
+CC1200Sim sim;
+CC1200Sim peerSim;
+CC1200 peer;
+bool json = false;
+
+byte frame[256];
+byte rxBuffer[256];
+
+// One benchmark case
+typedef struct BenchCase
+{
+	const char *NAME;
+	uint16_t LEN;				// Length byte, register count or table size
+	uint32_t RATE;				// Symbols (CFM: samples) per second requested (0: not on air)
+	uint16_t OPS;
+	uint16_t ERRORS;			// Timeouts / failed operations
+	uint32_t PAYLOAD;			// Payload bytes moved
+	uint32_t ELAPSED_US;
+	spiStats_t SPI;
+	uint32_t LATENCY[CFM_OPS];
+} benchCase_t;
+
+benchCase_t bench;
+
+/* =====================================================================================================================
+														REPORTING
+  ===================================================================================================================== */
+int compareUs(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+	return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of the sorted latencies
+uint32_t percentile(const uint32_t sorted[], uint16_t count, uint8_t p)
+{
+	if (count == 0)
+	{
+		return 0;
+	}
+	uint16_t rank = (uint16_t)(((uint32_t)p * count + 99) / 100);
+	return sorted[rank ? rank - 1 : 0];
+}
+
+void begin(const char *name, uint16_t len)
+{
+	memset(&bench, 0, sizeof(bench));
+	bench.NAME = name;
+	bench.LEN = len;
+	bench.RATE = 0;
+	cc1200.GetSpiStats(true);
+	bench.ELAPSED_US = micros();
+}
+
+void report(void)
+{
+	bench.ELAPSED_US = micros() - bench.ELAPSED_US;
+	bench.SPI = cc1200.GetSpiStats(true);
+	qsort(bench.LATENCY, bench.OPS, sizeof(bench.LATENCY[0]), compareUs);
+
+	double seconds = bench.ELAPSED_US / 1000000.0;
+	double opsPerSecond = seconds > 0 ? bench.OPS / seconds : 0;
+	double bytesPerSecond = seconds > 0 ? bench.PAYLOAD / seconds : 0;
+	double spiPerPayload = bench.PAYLOAD ? (double)bench.SPI.BYTES / bench.PAYLOAD : 0;
+	double spiPerOp = bench.OPS ? (double)bench.SPI.BYTES / bench.OPS : 0;
+	double csPerOp = bench.OPS ? (double)bench.SPI.CS_TOGGLES / bench.OPS : 0;
+	uint32_t p50 = percentile(bench.LATENCY, bench.OPS, 50);
+	uint32_t p90 = percentile(bench.LATENCY, bench.OPS, 90);
+	uint32_t p99 = percentile(bench.LATENCY, bench.OPS, 99);
+	uint32_t pMax = bench.OPS ? bench.LATENCY[bench.OPS - 1] : 0;
+
+	if (json)
+	{
+		printf("{\"case\":\"%s\",\"len\":%u,\"rate\":%lu,\"ops\":%u,\"errors\":%u,\"ops_per_s\":%.2f,"
+			"\"payload_bytes_per_s\":%.2f,\"spi_bytes_per_payload_byte\":%.3f,\"spi_bytes_per_op\":%.2f,"
+			"\"cs_per_op\":%.2f,\"latency_us\":{\"p50\":%lu,\"p90\":%lu,\"p99\":%lu,\"max\":%lu}}\n",
+			bench.NAME, bench.LEN, (unsigned long)bench.RATE, bench.OPS, bench.ERRORS, opsPerSecond,
+			bytesPerSecond, spiPerPayload, spiPerOp, csPerOp,
+			(unsigned long)p50, (unsigned long)p90, (unsigned long)p99, (unsigned long)pMax);
+	}
+	else
+	{
+		printf("%-16s %5u %7lu %5u %4u %11.1f %11.1f %8.3f %9.1f %6.2f %9lu %9lu %9lu %9lu\n",
+			bench.NAME, bench.LEN, (unsigned long)bench.RATE, bench.OPS, bench.ERRORS, opsPerSecond,
+			bytesPerSecond, spiPerPayload, spiPerOp, csPerOp,
+			(unsigned long)p50, (unsigned long)p90, (unsigned long)p99, (unsigned long)pMax);
+	}
+}
+
+void sample(uint32_t start, bool ok, uint16_t payload)
+{
+	bench.LATENCY[bench.OPS++] = micros() - start;
+	if (ok)
+	{
+		bench.PAYLOAD += payload;
+	}
+	else
+	{
+		bench.ERRORS++;
+	}
+}
+
+/* =====================================================================================================================
+														RADIO CASES
+  ===================================================================================================================== */
+volatile bool radioDone;
+volatile uint8_t radioResult;
+
+void radioComplete(uint8_t result, uint8_t len, void *context)
+{
+	(void)len;
+	(void)context;
+	radioResult = result;
+	radioDone = true;
+}
+
+void radioIsr(void)
+{
+	cc1200.RadioIrq();
+}
+
+// Symbol rate exponent; the mantissa of the preferred settings is kept
+void setRate(uint8_t exponent)
+{
+	cc1200.Idle();
+	cc1200.FlushTxFifo();
+	cc1200.FlushRxFifo();
+	byte rate2;
+	cc1200.ReadRegister(CC120X_SYMBOL_RATE2, &rate2, 1);
+	rate2 = (byte)((exponent << 4) | (rate2 & 0x0F));
+	cc1200.WriteRegister(CC120X_SYMBOL_RATE2, &rate2, 1);
+}
+
+void makeFrame(uint16_t len)
+{
+	frame[0] = (byte)len;
+	frame[1] = 0x00; // Broadcast target
+	frame[2] = 0x01;
+	for (uint16_t i = 3; i <= len; i++)
+	{
+		frame[i] = (byte)i;
+	}
+}
+
+// Status byte state (bits 6:4): a single SPI byte per poll
+uint8_t pollState(void)
+{
+	return cc1200.GetStat(STATUS, 0x70, 4);
+}
+
+// Wait for state to be left (leave = true) or entered, polling the status byte
+bool pollUntil(uint8_t state, bool leave, uint32_t start)
+{
+	while ((pollState() == state) == leave)
+	{
+		if (micros() - start > WAIT_US)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Sleep until the completion callback ran, as a main loop would
+bool waitCallback(uint32_t start)
+{
+	while (!radioDone)
+	{
+		delayMicroseconds(1);
+		cc1200.ServiceRadio();
+		if (micros() - start > WAIT_US)
+		{
+			return false;
+		}
+	}
+	return radioResult == RADIO_OK;
+}
+
+// WriteTxFifo + STX, completion by polling the status byte until IDLE
+void benchTxPoll(uint16_t len)
+{
+	for (uint16_t i = 0; i < RADIO_OPS; i++)
+	{
+		uint32_t start = micros();
+		cc1200.WriteTxFifo(frame, (uint8_t)len);
+		cc1200.Transmit();
+		bool ok = pollUntil(STATE_IDLE, true, start) && pollUntil(STATE_IDLE, false, start);
+		sample(start, ok, len - 2);
+	}
+}
+
+// SendAsync, completion by the packet interrupt
+void benchTxIrq(uint16_t len)
+{
+	for (uint16_t i = 0; i < RADIO_OPS; i++)
+	{
+		uint32_t start = micros();
+		radioDone = false;
+		bool ok = cc1200.SendAsync(frame, radioComplete, NULL, WAIT_US) && waitCallback(start);
+		sample(start, ok, len - 2);
+	}
+}
+
+// BeginTxStream + ServiceTxStream polled (any length)
+void benchTxStream(uint16_t len)
+{
+	for (uint16_t i = 0; i < RADIO_OPS; i++)
+	{
+		uint32_t start = micros();
+		bool ok = cc1200.BeginTxStream(frame, len + 1);
+		uint8_t state = STREAM_ACTIVE;
+		while (ok && state != STREAM_DONE)
+		{
+			state = cc1200.ServiceTxStream();
+			ok = (state != STREAM_ERROR) && (micros() - start <= WAIT_US);
+		}
+		sample(start, ok, len - 2);
+	}
+}
+
+// Receive + frame on air, completion by polling the status byte until IDLE (RXOFF_MODE), then ReadRxFifo
+void benchRxPoll(uint16_t len)
+{
+	for (uint16_t i = 0; i < RADIO_OPS; i++)
+	{
+		cc1200.Receive();
+		pollUntil(STATE_RX, false, micros());
+		uint32_t start = micros();
+		sim.InjectPacket(frame, len + 1);
+		bool ok = pollUntil(STATE_IDLE, false, start) && cc1200.ReadRxFifo(rxBuffer) == len + 3; // Frame + RSSI, LQI
+		sample(start, ok, len - 2);
+	}
+}
+
+// StartReceive + frame on air, completion by the packet interrupt
+void benchRxIrq(uint16_t len)
+{
+	for (uint16_t i = 0; i < RADIO_OPS; i++)
+	{
+		radioDone = false;
+		cc1200.StartReceive(rxBuffer, 255, radioComplete);
+		delayMicroseconds(RX_SETTLE_US);
+		uint32_t start = micros();
+		sim.InjectPacket(frame, len + 1);
+		sample(start, waitCallback(start), len - 2);
+	}
+}
+
+void runRadio(const char *name, void (*run)(uint16_t), uint16_t maxLen)
+{
+	for (uint8_t r = 0; r < sizeof(RATE_EXPONENTS); r++)
+	{
+		for (uint8_t l = 0; l < sizeof(LENGTHS) / sizeof(LENGTHS[0]); l++)
+		{
+			if (LENGTHS[l] > maxLen)
+			{
+				continue;
+			}
+			setRate(RATE_EXPONENTS[r]);
+			makeFrame(LENGTHS[l]);
+			begin(name, LENGTHS[l]);
+			bench.RATE = sim.SymbolRate();
+			run(LENGTHS[l]);
+			report();
+		}
+	}
+}
+
+/* =====================================================================================================================
+													REGISTER CASES
+  ===================================================================================================================== */
+// Configuration table written with Configure() (runs of consecutive registers as bursts)
+void benchConfigureBurst(uint8_t size)
+{
+	for (uint16_t i = 0; i < REGISTER_OPS; i++)
+	{
+		uint32_t start = micros();
+		sample(start, cc1200.Configure(preferredSettings, size), size);
+	}
+}
+
+// The same table, one WriteRegister() per entry
+void benchConfigureSingle(uint8_t size)
+{
+	for (uint16_t i = 0; i < REGISTER_OPS; i++)
+	{
+		uint32_t start = micros();
+		bool ok = true;
+		for (uint8_t j = 0; j < size; j++)
+		{
+			byte value = preferredSettings[j].VALUE;
+			ok &= cc1200.WriteRegister(preferredSettings[j].REGISTER, &value, 1);
+		}
+		sample(start, ok, size);
+	}
+}
+
+// The same table through the register cache: WriteRegister() per entry, then one coalesced Flush()
+void benchConfigureCached(uint8_t size)
+{
+	cc1200.EnableCache(true);
+	for (uint16_t i = 0; i < REGISTER_OPS; i++)
+	{
+		uint32_t start = micros();
+		bool ok = true;
+		for (uint8_t j = 0; j < size; j++)
+		{
+			byte value = preferredSettings[j].VALUE ^ (i & 1); // Always dirty
+			ok &= cc1200.WriteRegister(preferredSettings[j].REGISTER, &value, 1);
+		}
+		cc1200.Flush();
+		sample(start, ok, size);
+	}
+	cc1200.EnableCache(false);
+	cc1200.Configure(preferredSettings, prefSettLen);
+}
+
+// Read size consecutive registers from IOCFG3, one transaction each
+void benchReadSingle(uint8_t size)
+{
+	for (uint16_t i = 0; i < REGISTER_OPS; i++)
+	{
+		uint32_t start = micros();
+		bool ok = true;
+		for (uint8_t j = 0; j < size; j++)
+		{
+			ok &= cc1200.ReadRegister(CC120X_IOCFG3 + j, &rxBuffer[j], 1);
+		}
+		sample(start, ok, size);
+	}
+}
+
+// The same registers in one burst
+void benchReadBurst(uint8_t size)
+{
+	for (uint16_t i = 0; i < REGISTER_OPS; i++)
+	{
+		uint32_t start = micros();
+		sample(start, cc1200.ReadRegister(CC120X_IOCFG3, rxBuffer, size), size);
+	}
+}
+
+void runRegister(const char *name, void (*run)(uint8_t))
+{
+	cc1200.Idle();
+	for (uint8_t s = 0; s < sizeof(TABLE_SIZES); s++)
+	{
+		begin(name, TABLE_SIZES[s]);
+		run(TABLE_SIZES[s]);
+		report();
+	}
+}
+
+// Profile switch preferredSettings <-> rxSniffSettings, back to RX: full tables, Configure + SCAL
+void benchProfileFull(uint8_t size)
+{
+	(void)size;
+	for (uint16_t i = 0; i < REGISTER_OPS; i++)
+	{
+		uint32_t start = micros();
+		bool sniff = !(i & 1);
+		cc1200.Idle();
+		bool ok = sniff ? cc1200.Configure(rxSniffSettings, rxSniffSettLen) : cc1200.Configure(preferredSettings, prefSettLen);
+		cc1200.Strobe(CC120X_SCAL);
+		ok = ok && cc1200.WaitState(MARC_STATE_IDLE);
+		cc1200.Strobe(CC120X_SRX);
+		ok = ok && cc1200.WaitState(MARC_STATE_RX);
+		sample(start, ok, sniff ? rxSniffSettLen : prefSettLen);
+	}
+}
+
+// The same switches with precomputed diffs (SwitchProfile)
+void benchProfileDiff(uint8_t size)
+{
+	(void)size;
+	registerSetting_t toSniffSettings[rxSniffSettLen], toPrefSettings[prefSettLen];
+	profileDiff_t toSniff, toPref;
+	CC1200::BuildProfileDiff(preferredSettings, prefSettLen, rxSniffSettings, rxSniffSettLen, toSniffSettings, rxSniffSettLen, &toSniff);
+	CC1200::BuildProfileDiff(rxSniffSettings, rxSniffSettLen, preferredSettings, prefSettLen, toPrefSettings, prefSettLen, &toPref);
+	bench.LEN = toSniff.LEN;
+
+	for (uint16_t i = 0; i < REGISTER_OPS; i++)
+	{
+		uint32_t start = micros();
+		const profileDiff_t *diff = (i & 1) ? &toPref : &toSniff;
+		sample(start, cc1200.SwitchProfile(diff), diff->LEN);
+	}
+}
+
+void runProfile(const char *name, void (*run)(uint8_t))
+{
+	cc1200.Idle();
+	cc1200.Configure(preferredSettings, prefSettLen);
+	begin(name, prefSettLen);
+	run(prefSettLen);
+	report();
+	cc1200.Idle();
+	cc1200.Configure(preferredSettings, prefSettLen);
+}
+
+/* =====================================================================================================================
+													CFM STREAMING
+  ===================================================================================================================== */
+int8_t cfmBuffer[2 * CFM_HALF];
+int8_t cfmNext;
+
+void cfmFill(int8_t samples[], uint16_t len, void *context)
+{
+	(void)context;
+	for (uint16_t i = 0; i < len; i++)
+	{
+		samples[i] = cfmNext++;
+	}
+}
+
+void cfmDrain(int8_t samples[], uint16_t len, void *context)
+{
+	(void)samples;
+	(void)len;
+	(void)context;
+}
+
+// CfmTick() on an absolute sample clock as from a timer, ServiceCfm() in between. Latency is the interval between
+// samples reaching the chip, so its spread is the jitter and ops/s the sustained rate.
+void benchCfm(uint8_t direction, uint32_t rate)
+{
+	cc1200.Idle();
+	cc1200.BeginCfm(direction, cfmBuffer, CFM_HALF, direction == CFM_TX ? cfmFill : cfmDrain);
+	delayMicroseconds(RX_SETTLE_US);
+	cc1200.GetSpiStats(true);
+	bench.ELAPSED_US = micros();
+
+	uint32_t start = micros(), last = start;
+	for (uint16_t i = 0; i < CFM_OPS; i++)
+	{
+		uint32_t due = start + (uint32_t)((uint64_t)i * 1000000UL / rate);
+		if ((int32_t)(due - micros()) > 0)
+		{
+			delayMicroseconds(due - micros());
+		}
+		cc1200.CfmTick();
+		sample(i ? last : micros(), true, 1);
+		last = micros();
+		cc1200.ServiceCfm();
+	}
+	cfmStats_t stats = cc1200.GetCfmStats();
+	bench.ERRORS = (uint16_t)(stats.UNDERRUNS + stats.OVERRUNS);
+	cc1200.EndCfm();
+}
+
+void runCfm(const char *name, uint8_t direction)
+{
+	for (uint8_t r = 0; r < sizeof(SAMPLE_RATES) / sizeof(SAMPLE_RATES[0]); r++)
+	{
+		begin(name, CFM_HALF);
+		bench.RATE = SAMPLE_RATES[r];
+		benchCfm(direction, SAMPLE_RATES[r]);
+		report();
+	}
+}
+
+/* =====================================================================================================================
+														ARQ CASES
+  ===================================================================================================================== */
+uint32_t arqSentAt[ARQ_OPS];
+
+void arqIsr(void)
+{
+	cc1200.QueueRxFrame();
+}
+
+void peerIsr(void)
+{
+	peer.QueueRxFrame();
+}
+
+// Receiver: one sample per message delivered, Send() to in-order delivery
+void arqDelivered(uint8_t source, const byte data[], uint8_t len, void *context)
+{
+	(void)source;
+	(void)context;
+	uint16_t index = data[0] | ((uint16_t)data[1] << 8);
+	sample(index < ARQ_OPS ? arqSentAt[index] : micros(), index == bench.OPS, len);
+}
+
+// ARQ_OPS messages of ARQ_PAYLOAD_MAX bytes cc1200 -> peer, both main loops polled every ARQ_LOOP_US
+void benchArq(uint8_t window)
+{
+	CC1200Arq sender(cc1200, 0x01);
+	CC1200Arq receiver(peer, 0x02);
+	sender.Begin(NULL);
+	receiver.Begin(arqDelivered);
+	sender.SetWindow(window);
+
+	uint16_t queued = 0;
+	uint32_t start = micros();
+	while (bench.OPS < ARQ_OPS && micros() - start < ARQ_OPS * WAIT_US)
+	{
+		while (queued < ARQ_OPS)
+		{
+			frame[0] = lowByte(queued);
+			frame[1] = highByte(queued);
+			if (!sender.Send(0x02, frame, ARQ_PAYLOAD_MAX))
+			{
+				break;
+			}
+			arqSentAt[queued++] = micros();
+		}
+
+		rxFrame_t *received;
+		while ((received = cc1200.PeekFrame()) != NULL)
+		{
+			sender.Receive(received);
+			cc1200.PopFrame();
+		}
+		while ((received = peer.PeekFrame()) != NULL)
+		{
+			receiver.Receive(received);
+			peer.PopFrame();
+		}
+		sender.Service();
+		receiver.Service();
+		delayMicroseconds(ARQ_LOOP_US);
+	}
+	bench.ERRORS += ARQ_OPS - bench.OPS;
+}
+
+void runArq(const char *name, uint8_t lossPercent)
+{
+	sim.Link(&peerSim);
+	peerSim.Link(&sim);
+	sim.SetLoss(lossPercent, 1);
+	peerSim.SetLoss(lossPercent, 2);
+	cc1200.SetAddress(0x01);
+	peer.SetAddress(0x02);
+	attachInterrupt(digitalPinToInterrupt(IRQ_PIN), arqIsr, FALLING);
+
+	for (uint8_t r = 0; r < sizeof(RATE_EXPONENTS); r++)
+	{
+		for (uint8_t w = 0; w < sizeof(ARQ_WINDOWS); w++)
+		{
+			setRate(RATE_EXPONENTS[r]);
+			byte rate2;
+			cc1200.ReadRegister(CC120X_SYMBOL_RATE2, &rate2, 1);
+			peer.Idle();
+			peer.FlushTxFifo();
+			peer.FlushRxFifo();
+			peer.WriteRegister(CC120X_SYMBOL_RATE2, &rate2, 1);
+			begin(name, ARQ_WINDOWS[w]);
+			bench.RATE = sim.SymbolRate();
+			benchArq(ARQ_WINDOWS[w]);
+			report();
+		}
+	}
+
+	attachInterrupt(digitalPinToInterrupt(IRQ_PIN), radioIsr, FALLING);
+}
+
+/* =====================================================================================================================
+														AGGREGATION CASES
+  ===================================================================================================================== */
+uint32_t aggSentAt[AGG_OPS];
+
+// Receiver: one sample per message, Send() (queued) to delivery
+void aggDelivered(uint8_t source, const byte data[], uint8_t len, void *context)
+{
+	(void)source;
+	(void)context;
+	uint16_t index = data[0] | ((uint16_t)data[1] << 8);
+	sample(index < AGG_OPS ? aggSentAt[index] : micros(), index == bench.OPS, len);
+}
+
+// One message per frame [Length Target Source --Message--] once the previous one is on air
+bool sendSingle(const byte message[], uint8_t size)
+{
+	uint8_t state = pollState();
+	if (state != STATE_IDLE && state != STATE_RX)
+	{
+		return false;
+	}
+	frame[0] = size + 2;
+	frame[1] = 0x02;
+	frame[2] = 0x01;
+	memcpy(&frame[3], message, size);
+	cc1200.WriteTxFifo(frame, frame[0]);
+	cc1200.Transmit();
+	return true;
+}
+
+// AGG_OPS messages of size bytes cc1200 -> peer, queued as fast as they are taken, main loop every ARQ_LOOP_US
+void benchMessages(uint8_t size, bool aggregate)
+{
+	CC1200Aggregator sender(cc1200, 0x01);
+	CC1200Aggregator receiver(peer, 0x02);
+	sender.Begin(NULL);
+	receiver.Begin(aggDelivered);
+	peer.Receive();
+
+	byte message[16];
+	memset(message, 0xA5, sizeof(message));
+	uint16_t queued = 0;
+	uint32_t start = micros();
+	while (bench.OPS < AGG_OPS && micros() - start < AGG_OPS * WAIT_US)
+	{
+		if (queued < AGG_OPS)
+		{
+			message[0] = lowByte(queued);
+			message[1] = highByte(queued);
+			if (aggregate ? sender.Send(0x02, message, size) : sendSingle(message, size))
+			{
+				aggSentAt[queued++] = micros();
+			}
+		}
+
+		rxFrame_t *received;
+		while ((received = peer.PeekFrame()) != NULL)
+		{
+			if (!receiver.Receive(received) && received->LEN > 3)
+			{
+				aggDelivered(received->DATA[2], &received->DATA[3], received->LEN - 3, NULL);
+			}
+			peer.PopFrame();
+		}
+		if (queued == AGG_OPS)
+		{
+			sender.Flush(); // End of the burst: no deadline wait for the last frame
+		}
+		else
+		{
+			sender.Service();
+		}
+		delayMicroseconds(ARQ_LOOP_US);
+	}
+	bench.ERRORS += AGG_OPS - bench.OPS;
+}
+
+void runMessages(const char *name, bool aggregate)
+{
+	sim.SetLoss(0, 1);
+	peerSim.SetLoss(0, 2);
+	for (uint8_t r = 0; r < sizeof(RATE_EXPONENTS); r++)
+	{
+		for (uint8_t m = 0; m < sizeof(MESSAGE_SIZES); m++)
+		{
+			setRate(RATE_EXPONENTS[r]);
+			byte rate2;
+			cc1200.ReadRegister(CC120X_SYMBOL_RATE2, &rate2, 1);
+			peer.Idle();
+			peer.FlushTxFifo();
+			peer.FlushRxFifo();
+			peer.WriteRegister(CC120X_SYMBOL_RATE2, &rate2, 1);
+			begin(name, MESSAGE_SIZES[m]);
+			bench.RATE = sim.SymbolRate();
+			benchMessages(MESSAGE_SIZES[m], aggregate);
+			report();
+		}
+	}
+}
+
+/* =====================================================================================================================
+														MAIN
+  ===================================================================================================================== */
+int main(int argc, char *argv[])
+{
+	json = (argc > 1 && strcmp(argv[1], "--json") == 0);
+
+	sim.Attach(SS);
+	sim.ConnectGpio(2, IRQ_PIN);
+	cc1200.Init();
+	cc1200.Configure(preferredSettings, prefSettLen);
+	attachInterrupt(digitalPinToInterrupt(IRQ_PIN), radioIsr, FALLING);
+	peerSim.Attach(PEER_SS);
+	peerSim.ConnectGpio(2, PEER_IRQ_PIN);
+	peer.Init(PEER_SS, MOSI, MISO, SCK, PIN_UNUSED);
+	peer.Configure(preferredSettings, prefSettLen);
+	attachInterrupt(digitalPinToInterrupt(PEER_IRQ_PIN), peerIsr, FALLING);
+
+	if (!json)
+	{
+		printf("%-16s %5s %7s %5s %4s %11s %11s %8s %9s %6s %9s %9s %9s %9s\n", "case", "len", "rate", "ops", "err",
+			"ops/s", "payload B/s", "spi/B", "spi/op", "cs/op", "p50 us", "p90 us", "p99 us", "max us");
+	}
+
+	// Register access and configuration table size (payload = registers)
+	runRegister("cfg_burst", benchConfigureBurst);
+	runRegister("cfg_single", benchConfigureSingle);
+	runRegister("cfg_cached", benchConfigureCached);
+	runRegister("reg_read_single", benchReadSingle);
+	runRegister("reg_read_burst", benchReadBurst);
+
+	// PHY profile switch and back to RX (payload = registers written; len = registers in the diff)
+	runProfile("profile_full", benchProfileFull);
+	runProfile("profile_diff", benchProfileDiff);
+
+	// Packets over length x symbol rate (payload = length byte - 2 address bytes)
+	runRadio("tx_poll", benchTxPoll, FIFO_MAX_LEN);
+	runRadio("tx_irq", benchTxIrq, FIFO_MAX_LEN);
+	runRadio("tx_stream", benchTxStream, 255);
+	runRadio("rx_poll", benchRxPoll, FIFO_MAX_LEN);
+	runRadio("rx_irq", benchRxIrq, FIFO_MAX_LEN);
+
+	// Continuous CFM streaming over sample rate (payload = samples; len = double buffer half)
+	runCfm("cfm_tx", CFM_TX);
+	runCfm("cfm_rx", CFM_RX);
+
+	// ARQ bulk transfer over window size x symbol rate, clean and lossy link (payload = messages delivered in
+	// order; len = window; SPI of both radios). Runs last: it sets device addresses and links the simulators.
+	runArq("arq_loss0", 0);
+	runArq("arq_loss10", 10);
+
+	// Small messages over size x symbol rate on the clean link, one frame each against aggregated (payload = message
+	// bytes delivered; len = message size; latency = queued to delivered)
+	runMessages("msg_single", false);
+	runMessages("msg_aggregate", true);
+
+	return 0;
+}
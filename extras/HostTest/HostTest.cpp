@@ -0,0 +1,187 @@
+#include "CC1200.h"				// TI CC1200 RF Radio
+#include "CC120X_Sim.h"			// Chip simulator (host)
+
+#include <stdio.h>
+#include <string.h>
+
+// Host regression tests: the unmodified driver against the chip simulator on the virtual clock.
+// Each case checks a corner the examples and the benchmark do not reach. Exits with the number of failed checks.
+//
+// Build and run from the library root (the Arduino IDE ignores extras/):
+//   g++ -std=gnu++11 -O2 -I. -o hosttest extras/HostTest/HostTest.cpp *.cpp
+//   ./hosttest
+
+#define BURST_MAX_LEN	255			// Largest transfer: header + data passes 256 positions
+#define IRQ_PIN			2			// Host pin driven by GPIO0 (MCU_WAKEUP)
+#define WAIT_US			2000000UL	// Give up on a radio event after this long
+
+CC1200Sim sim;
+int failures = 0;
+
+#define CHECK(cond)	check((cond), #cond, __LINE__)
+
+void check(bool ok, const char *what, int line)
+{
+	if (!ok)
+	{
+		printf("  FAIL line %d: %s\n", line, what);
+		failures++;
+	}
+}
+
+/* Cases */
+// 255-byte burst read and write with 1-byte (normal space) and 2-byte (extended space) header
+void testLongBurst(void)
+{
+	byte out[BURST_MAX_LEN], in[BURST_MAX_LEN];
+	const uint16_t bases[] = { CC120X_IOCFG3, CC120X_IF_MIX_CFG };
+	uint8_t writable[] = { CC120X_PKT_LEN + 1, lowByte(CC120X_WOR_TIME1) - lowByte(CC120X_IF_MIX_CFG) };
+
+	printf("Long burst\n");
+	for (uint8_t b = 0; b < 2; b++)
+	{
+		for (uint16_t i = 0; i < BURST_MAX_LEN; i++)
+		{
+			out[i] = (byte)(i * 7 + b);
+		}
+		memset(in, 0, sizeof(in));
+		uint32_t writes = sim.Stats.REG_WRITES, reads = sim.Stats.REG_READS;
+
+		cc1200.WriteRegister(bases[b], out, BURST_MAX_LEN);
+		cc1200.ReadRegister(bases[b], in, BURST_MAX_LEN);
+
+		CHECK(sim.Stats.REG_WRITES - writes == BURST_MAX_LEN);
+		CHECK(sim.Stats.REG_READS - reads == BURST_MAX_LEN);
+		CHECK(memcmp(in, out, writable[b]) == 0);	// Read-only and unmapped addresses after these
+	}
+}
+
+// Configure() confirms a written register, not the status entries (PARTVERSION) at the end of the table
+void testConfigureReadback(void)
+{
+	const registerSetting_t statusOnly[] = { { CC120X_PARTVERSION, 0x11 } };
+
+	printf("Configure readback\n");
+	sim.Poke(CC120X_PARTVERSION, 0x21);		// Other chip revision
+	CHECK(cc1200.Configure(preferredSettings, prefSettLen));
+	CHECK(!cc1200.Configure(statusOnly, 1));
+	sim.Poke(CC120X_PARTVERSION, 0x11);
+}
+
+// A fast start whose Configure() does not read back ends in BOOT_FAILED, not BOOT_DONE
+void testFastStartFailed(void)
+{
+	const registerSetting_t statusOnly[] = { { CC120X_PARTVERSION, 0x11 } };
+
+	printf("Fast start failed\n");
+	CHECK(!cc1200.FastStart(statusOnly, 1, true));
+	CHECK(cc1200.ServiceFastStart(BOOT_TIMEOUT_US) == BOOT_FAILED);
+	CHECK(cc1200.FastStart(preferredSettings, prefSettLen, false));
+}
+
+// A length byte of 255 must not wrap the frame length to 0 and strobe TX on an empty FIFO
+void testSendTooLong(void)
+{
+	byte frame[256];
+	memset(frame, 0x55, sizeof(frame));
+	frame[0] = 255;
+
+	printf("Send too long\n");
+	uint32_t strobes = sim.Stats.STROBES;
+	CHECK(cc1200.SendCsma(frame, RADIO_TIMEOUT_US) == RADIO_TOO_LONG);
+	CHECK(!cc1200.SendAsync(frame, NULL));
+	CHECK(!cc1200.RadioBusy());
+	CHECK(sim.Stats.STROBES == strobes);
+	CHECK(sim.Peek(CC120X_NUM_TXBYTES) == 0);
+}
+
+// AttachIrq() programs GPIO_MCU_WAKEUP without inversion: its RISING edge must reach DispatchIrq()
+volatile uint8_t irqCauses = 0;
+void onRxOk(uint8_t status, void *context)
+{
+	(void)status;
+	(void)context;
+	irqCauses++;
+}
+
+void testAttachIrqEdge(void)
+{
+	const byte frame[] = { 3, 0x00, 0x01, 0x42 };
+
+	printf("AttachIrq edge\n");
+	sim.ConnectGpio(0, IRQ_PIN);
+	CHECK(cc1200.AttachIrq(IRQ_PIN, 0));
+	cc1200.OnIrq(IRQ_RX_OK, onRxOk);
+	cc1200.Receive();
+	delay(1);
+	CHECK(sim.InjectPacket(frame, sizeof(frame)));
+	uint32_t start = micros();
+	while (irqCauses == 0 && micros() - start < WAIT_US)
+	{
+		delayMicroseconds(100);
+	}
+	CHECK(irqCauses == 1);
+	cc1200.OnIrq(IRQ_RX_OK, NULL);
+	cc1200.Idle();
+	cc1200.FlushRxFifo();
+	sim.ConnectGpio(0, -1);
+}
+
+// Hop() restores calibration and frequency in one CS, FREQ2..0 as one burst
+void testHopOneTransaction(void)
+{
+	fsCal_t channels[2] = { { { 0x56, 0xCC, 0xCC }, 0, { 0 } }, { { 0x57, 0x33, 0x33 }, 0, { 0 } } };
+
+	printf("Hop in one transaction\n");
+	CHECK(cc1200.CalibrateHopSet(channels, 2) == 2);
+	uint32_t toggles = cc1200.GetSpiStats().CS_TOGGLES;
+	CHECK(cc1200.Hop(&channels[1], 0));
+	CHECK(cc1200.GetSpiStats().CS_TOGGLES - toggles == 2);	// SIDLE, then the writes
+	CHECK(sim.Peek(CC120X_FREQ2) == 0x57 && sim.Peek(CC120X_FREQ1) == 0x33 && sim.Peek(CC120X_FREQ0) == 0x33);
+	CHECK(sim.Peek(CC120X_FS_CHP) == channels[1].CHP);
+	CHECK(sim.Peek(CC120X_FS_VCO4) == channels[1].VCO[0] && sim.Peek(CC120X_FS_VCO2) == channels[1].VCO[2]);
+	CHECK(sim.FsCalibrated());
+	CHECK(cc1200.Configure(preferredSettings, prefSettLen));
+}
+
+// ConfigureSniff() at the longest latency: the largest WOR_RES with EVENT0 saturated, not wrapped to a short period
+void testSniffMaxLatency(void)
+{
+	const uint32_t rates[] = { 171799, 6872 };		// SYMBOL_RATE (E = 0): about 25 and 1 sps
+
+	printf("Sniff max latency\n");
+	CHECK(cc1200.Configure(rxSniffSettings, rxSniffSettLen));
+	for (uint8_t r = 0; r < 2; r++)
+	{
+		byte rate[3] = { (byte)(rates[r] >> 16), highByte(rates[r]), lowByte(rates[r]) };
+		cc1200.WriteRegister(CC120X_SYMBOL_RATE2, rate, 3);
+
+		uint32_t periodUs = cc1200.ConfigureSniff(0xFFFFFFFF, 0xFFFF);
+		byte worCfg1, event0[2];
+		cc1200.ReadRegister(CC120X_WOR_CFG1, &worCfg1, 1);
+		cc1200.ReadRegister(CC120X_WOR_EVENT0_MSB, event0, 2);
+		uint32_t ticks = ((uint32_t)event0[0] << 8 | event0[1]) << (5 * (worCfg1 >> 6));
+
+		CHECK((worCfg1 >> 6) == 3);
+		CHECK(periodUs > 1000000000UL);				// Over 1000 s: nothing wrapped
+		CHECK(periodUs == ticks * (1000000UL / SNIFF_RCOSC_HZ));
+	}
+	CHECK(cc1200.Configure(preferredSettings, prefSettLen));
+}
+
+int main(void)
+{
+	sim.Attach();
+	cc1200.Init();
+
+	testLongBurst();
+	testConfigureReadback();
+	testFastStartFailed();
+	testSendTooLong();
+	testAttachIrqEdge();
+	testHopOneTransaction();
+	testSniffMaxLatency();
+
+	printf("%s (%d failed)\n", failures ? "FAILED" : "PASSED", failures);
+	return failures;
+}